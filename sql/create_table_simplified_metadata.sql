@@ -0,0 +1,8 @@
+CREATE TABLE IF NOT EXISTS simplified_trajectories_metadata (
+                              trajectory_id           INTEGER PRIMARY KEY,
+                              parameters              TEXT NOT NULL,
+                              original_points         BIGINT NOT NULL,
+                              original_last_point_id  BIGINT NOT NULL,
+                              simplified_at           TIMESTAMPTZ NOT NULL DEFAULT now()
+);
+CREATE INDEX IF NOT EXISTS simplified_trajectories_index_trajectory_id ON simplified_trajectories (trajectory_id);
@@ -5,11 +5,10 @@
 #include "benchmark-query-objects/Benchmark_Range_Query.hpp"
 #include "benchmark-query-objects/Benchmark_KNN_Query.hpp"
 #include "../trajectory_data_handling/File_Manager.hpp"
+#include "../database/Connection_Pool.hpp"
 
 namespace analytics {
 
-    std::string Benchmark::connection_string{"user=postgres password=postgres host=localhost dbname=traceq port=5432"};
-
     double Benchmark::grid_density{0.02};
     double Benchmark::expansion_factor{grid_density * 0.8};
     int Benchmark::windows_per_grid_point{5};
@@ -23,9 +22,9 @@ namespace analytics {
         auto query = "SELECT min(coordinates[0]) as min_x, max(coordinates[0]) as max_x, min(coordinates[1]) as min_y, "
                      "max(coordinates[1]) as max_y, min(time) as min_t, max(time) as max_t FROM original_trajectories;";
 
-        pqxx::connection c{connection_string};
+        auto connection = database::Connection_Pool::shared().acquire();
 
-        pqxx::work txn{c};
+        pqxx::work txn{*connection};
 
         auto result = txn.exec1(query);
         txn.commit();
@@ -264,8 +263,8 @@ namespace analytics {
                  "FROM (SELECT COUNT(*) AS o_count FROM original_trajectories) t1_count, "
                  "(SELECT COUNT(*) AS s_count FROM simplified_trajectories) t2_count";
 
-        pqxx::connection c{connection_string};
-        pqxx::work txn{c};
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
 
         auto query_result = txn.exec1(query.str());
         txn.commit();
@@ -28,8 +28,6 @@ namespace analytics {
     };
 
     class Benchmark {
-    private:
-        static std::string connection_string;
     public:
         static int max_connections;
         static double expansion_factor;
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pqxx/pqxx>
+#include "../database/Connection_Pool.hpp"
+#include "../querying/KNN_Query.hpp"
+#include "../logging/Logger.hpp"
+
+/**
+ * Measures the latency of KNN queries on the original trajectories when every query opens its own connection, as
+ * before the connection pool, and when the connections are leased from a pool.
+ * Needs the database to be populated.
+ */
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+    using spatial_queries::KNN_Query;
+
+    /**
+     * Draws query origins uniformly from the bounding box of the original trajectories.
+     */
+    std::vector<KNN_Query::KNN_Origin> query_origins(int count) {
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
+        auto bounds = txn.exec1("SELECT min(coordinates[0]), max(coordinates[0]), min(coordinates[1]), "
+                                "max(coordinates[1]) FROM original_trajectories;");
+        txn.commit();
+
+        std::mt19937 gen(17);
+        std::uniform_real_distribution<double> x(bounds[0].as<double>(), bounds[1].as<double>());
+        std::uniform_real_distribution<double> y(bounds[2].as<double>(), bounds[3].as<double>());
+        std::vector<KNN_Query::KNN_Origin> result{};
+        for (int i = 0; i < count; ++i) {
+            result.push_back({x(gen), y(gen)});
+        }
+        return result;
+    }
+
+    /**
+     * Runs the queries split over the given number of threads, and returns the latency of every query in
+     * milliseconds, including the time spent opening or waiting for a connection.
+     */
+    std::vector<double> measure_latencies(std::vector<KNN_Query::KNN_Origin> const& origins, int threads,
+                                          std::function<void(KNN_Query::KNN_Origin const&)> const& query) {
+        std::vector<double> latencies(origins.size());
+        std::vector<std::thread> workers{};
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                for (auto i = static_cast<size_t>(t); i < origins.size(); i += threads) {
+                    auto start = Clock::now();
+                    query(origins[i]);
+                    latencies[i] = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        return latencies;
+    }
+
+    std::string summarize(std::vector<double> latencies) {
+        std::ranges::sort(latencies);
+        auto percentile = [&latencies](double p) {
+            return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))];
+        };
+        double mean{};
+        for (auto latency : latencies) {
+            mean += latency / static_cast<double>(latencies.size());
+        }
+
+        std::stringstream result{};
+        result << std::fixed << std::setprecision(2) << "mean " << mean << " ms, p50 " << percentile(0.5)
+               << " ms, p99 " << percentile(0.99) << " ms";
+        return result.str();
+    }
+
+    logging::Logger get_logger() {
+        auto in_time_t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::stringstream time_ss;
+        time_ss << std::put_time(std::localtime(&in_time_t), "%Y%m%d_%H%M%S");
+        return logging::Logger{"../../logs", "/connection_pool_benchmark_" + time_ss.str() + ".txt"};
+    }
+
+}
+
+int main() {
+    auto logger = get_logger();
+    auto const table = std::string{"original_trajectories"};
+    auto const k = 3;
+    auto origins = query_origins(2000);
+
+    logger << "KNN query latency, " + std::to_string(origins.size()) + " queries, pool capacity "
+              + std::to_string(database::Connection_Pool::shared().get_capacity());
+
+    for (int threads : {1, 8, 32}) {
+        auto unpooled = measure_latencies(origins, threads, [&](KNN_Query::KNN_Origin const& origin) {
+            pqxx::connection connection{database::Connection_Pool::default_connection_string};
+            KNN_Query::get_ids_from_knn(connection, table, k, origin);
+        });
+        auto pooled = measure_latencies(origins, threads, [&](KNN_Query::KNN_Origin const& origin) {
+            KNN_Query::get_ids_from_knn(table, k, origin);
+        });
+
+        logger << std::to_string(threads) + " threads, connection per query: " + summarize(unpooled);
+        logger << std::to_string(threads) + " threads, pooled connections: " + summarize(pooled);
+    }
+    return 0;
+}
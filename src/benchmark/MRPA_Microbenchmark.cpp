@@ -0,0 +1,483 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include "../data/Trajectory.hpp"
+#include "../simp-algorithms/SED_Oracle.hpp"
+#include "../simp-algorithms/MRPA.hpp"
+#include "../simp-algorithms/Segmented_MRPA.hpp"
+#include "../simp-algorithms/TD_TR.hpp"
+#include "../simp-algorithms/SQUISH_E.hpp"
+#include "../simp-algorithms/OPW.hpp"
+#include "../concurrency/Work_Stealing_Pool.hpp"
+#include "../logging/Logger.hpp"
+
+namespace {
+    /**
+     * The number of heap allocations made by the whole process so far.
+     */
+    std::atomic<unsigned long long> allocation_count{0};
+}
+
+// Counts every allocation, so that the stages can report how many allocations they make
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (auto* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+/**
+ * Standalone microbenchmarks of the MRPA building blocks.
+ * Everything runs on synthetic trajectories, so no database connection is needed.
+ */
+namespace {
+
+    using data_structures::Trajectory;
+
+    /**
+     * Creates a random walk with GPS-like coordinates and epoch timestamps.
+     * @param size The number of locations.
+     * @param seed Seed of the random number generator.
+     */
+    Trajectory synthetic_trajectory(int size, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<double> step(-0.001, 0.001);
+        std::uniform_int_distribution<unsigned long> interval(1, 600);
+
+        Trajectory trajectory{};
+        double longitude = 116.3;
+        double latitude = 39.9;
+        unsigned long timestamp = 1201930000;
+        for (int i = 1; i <= size; ++i) {
+            trajectory.locations.emplace_back(data_structures::Location(i, timestamp, longitude, latitude));
+            longitude += step(gen);
+            latitude += step(gen);
+            timestamp += interval(gen);
+        }
+        return trajectory;
+    }
+
+    /**
+     * Creates a trajectory moving in a straight line at constant speed and sampling rate, with GPS-like noise of
+     * about 10 cm on every coordinate.
+     * @param size The number of locations.
+     * @param seed Seed of the random number generator.
+     */
+    Trajectory straight_line_trajectory(int size, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::normal_distribution<double> noise(0, 0.000001);
+
+        Trajectory trajectory{};
+        for (int i = 1; i <= size; ++i) {
+            trajectory.locations.emplace_back(data_structures::Location(
+                    i, 1201930000 + 5ul * i, 116.3 + 0.0001 * i + noise(gen), 39.9 + 0.00005 * i + noise(gen)));
+        }
+        return trajectory;
+    }
+
+    /**
+     * Creates a trajectory that alternates between driving and standing still, like a vehicle in city traffic.
+     * While standing still the locations only jitter around the stop, and the sampling rate is lower.
+     * @param size The number of locations.
+     * @param seed Seed of the random number generator.
+     */
+    Trajectory stop_and_go_trajectory(int size, unsigned int seed) {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<double> step(-0.001, 0.001);
+        std::normal_distribution<double> jitter(0, 0.00001);
+        std::uniform_int_distribution<int> phase_length(5, 50);
+
+        Trajectory trajectory{};
+        double longitude = 116.3;
+        double latitude = 39.9;
+        unsigned long timestamp = 1201930000;
+        bool moving = true;
+        int remaining = phase_length(gen);
+        for (int i = 1; i <= size; ++i) {
+            if (moving) {
+                longitude += step(gen);
+                latitude += step(gen);
+                timestamp += 10;
+                trajectory.locations.emplace_back(data_structures::Location(i, timestamp, longitude, latitude));
+            }
+            else {
+                timestamp += 60;
+                trajectory.locations.emplace_back(data_structures::Location(
+                        i, timestamp, longitude + jitter(gen), latitude + jitter(gen)));
+            }
+            if (--remaining == 0) {
+                moving = !moving;
+                remaining = phase_length(gen);
+            }
+        }
+        return trajectory;
+    }
+
+    /**
+     * Runs the given range query over every segment of the given length and reports the throughput in points
+     * per second.
+     * @param func Callable taking the 1-indexed start and end of a segment and returning its squared SED sum.
+     */
+    template<typename F>
+    double points_per_second(F&& func, int trajectory_size, int segment_length) {
+        constexpr int repetitions = 20;
+        double checksum{};
+        long long points{};
+
+        auto start = std::chrono::steady_clock::now();
+        for (int repetition = 0; repetition < repetitions; ++repetition) {
+            for (int i = 1; i + segment_length - 1 <= trajectory_size; ++i) {
+                checksum += func(i, i + segment_length - 1);
+                points += segment_length - 2;
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        // Keeps the compiler from discarding the work
+        if (checksum < 0) {
+            return 0;
+        }
+        return static_cast<double>(points) / elapsed.count();
+    }
+
+    /**
+     * Compares the SED oracle, which sums short segments directly and longer ones in closed form, with the direct sum
+     * of the reference implementation. Around the direct sum limit of the oracle, both of its paths cost the same.
+     */
+    void benchmark_sed_oracle(logging::Logger& logger) {
+        logger << "SED oracle benchmark (points per second)";
+
+        constexpr int trajectory_size = 4000;
+        auto trajectory = synthetic_trajectory(trajectory_size, 42);
+        auto oracle = simp_algorithms::SED_Oracle{trajectory};
+
+        for (int segment_length : {4, 10, 16, 32, 128, 1024}) {
+            std::stringstream line;
+            line << "Segment length " << segment_length << ":";
+
+            line << " direct sum " << std::scientific << std::setprecision(3) << points_per_second(
+                    [&](int i, int j) { return simp_algorithms::SED_Oracle::direct_sum(trajectory, i, j); },
+                    trajectory_size, segment_length);
+            line << ", oracle " << points_per_second(
+                    [&](int i, int j) { return oracle(i, j); }, trajectory_size, segment_length);
+
+            logger << line.str();
+        }
+    }
+
+    /**
+     * The average compression ratio over all levels, where the compression ratio of a level is the fraction of
+     * points removed from the original trajectory.
+     */
+    double average_compression_ratio(std::vector<Trajectory> const& levels, size_t original_size) {
+        double sum{};
+        for (auto const& level : levels) {
+            sum += 1 - static_cast<double>(level.size()) / static_cast<double>(original_size);
+        }
+        return levels.empty() ? 0 : sum / static_cast<double>(levels.size());
+    }
+
+    void benchmark_mrpa_modes(logging::Logger& logger) {
+        logger << "MRPA cascading vs independent levels";
+
+        constexpr double resolution_scale = 1.1;
+        auto cascading = simp_algorithms::MRPA{resolution_scale, simp_algorithms::MRPA::Mode::cascading};
+        auto independent = simp_algorithms::MRPA{resolution_scale, simp_algorithms::MRPA::Mode::independent};
+
+        for (int trajectory_size : {1000, 5000}) {
+            auto trajectory = synthetic_trajectory(trajectory_size, 7);
+
+            std::vector<Trajectory> cascading_levels{};
+            std::vector<Trajectory> independent_levels{};
+            auto start = std::chrono::steady_clock::now();
+            cascading_levels = cascading(trajectory);
+            std::chrono::duration<double> cascading_time = std::chrono::steady_clock::now() - start;
+            start = std::chrono::steady_clock::now();
+            independent_levels = independent(trajectory);
+            std::chrono::duration<double> independent_time = std::chrono::steady_clock::now() - start;
+
+            auto cascading_ratio = average_compression_ratio(cascading_levels, trajectory.size());
+            auto independent_ratio = average_compression_ratio(independent_levels, trajectory.size());
+
+            std::stringstream line;
+            line << std::fixed << std::setprecision(4) << "N = " << trajectory_size
+                 << ": cascading " << cascading_time.count() << "s (" << cascading_levels.size() << " levels)"
+                 << ", independent " << independent_time.count() << "s (" << independent_levels.size() << " levels)"
+                 << ", speedup " << cascading_time.count() / independent_time.count()
+                 << ", average compression ratio " << cascading_ratio << " vs " << independent_ratio
+                 << " (difference " << independent_ratio - cascading_ratio << ")";
+            logger << line.str();
+        }
+    }
+
+    /**
+     * Simplifies the trajectory with the given algorithm and reports its throughput in points per second.
+     */
+    template<typename Algorithm>
+    std::string throughput(std::string const& name, Trajectory const& trajectory, double resolution_scale) {
+        auto algorithm = Algorithm{resolution_scale};
+        auto start = std::chrono::steady_clock::now();
+        auto levels = algorithm(trajectory);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::stringstream result;
+        result << name << " " << std::scientific << std::setprecision(3)
+               << static_cast<double>(trajectory.size()) / elapsed.count() << " (" << levels.size() << " levels)";
+        return result.str();
+    }
+
+    void benchmark_error_metrics(logging::Logger& logger) {
+        logger << "MRPA throughput per error metric (points per second)";
+
+        constexpr double resolution_scale = 1.1;
+        for (int trajectory_size : {1000, 5000}) {
+            auto trajectory = synthetic_trajectory(trajectory_size, 13);
+            logger << "N = " + std::to_string(trajectory_size) + ": "
+                      + throughput<simp_algorithms::MRPA>("SED", trajectory, resolution_scale) + ", "
+                      + throughput<simp_algorithms::PED_MRPA>("PED", trajectory, resolution_scale) + ", "
+                      + throughput<simp_algorithms::DAD_MRPA>("DAD", trajectory, resolution_scale);
+        }
+    }
+
+    void benchmark_candidate_generators(logging::Logger& logger) {
+        logger << "Candidate generator throughput (points per second)";
+
+        constexpr double resolution_scale = 1.1;
+        for (int trajectory_size : {1000, 10000}) {
+            auto trajectory = synthetic_trajectory(trajectory_size, 19);
+            logger << "N = " + std::to_string(trajectory_size) + ": "
+                      + throughput<simp_algorithms::MRPA>("MRPA", trajectory, resolution_scale) + ", "
+                      + throughput<simp_algorithms::TD_TR>("TD-TR", trajectory, resolution_scale) + ", "
+                      + throughput<simp_algorithms::SQUISH_E>("SQUISH-E", trajectory, resolution_scale) + ", "
+                      + throughput<simp_algorithms::OPW>("OPW", trajectory, resolution_scale);
+        }
+    }
+
+    void benchmark_batch(logging::Logger& logger) {
+        logger << "MRPA batch of skewed trajectory sizes, sequential vs work-stealing";
+
+        constexpr double resolution_scale = 1.1;
+        auto mrpa = simp_algorithms::MRPA{resolution_scale};
+
+        // A few long trajectories among many short ones, in random order
+        std::vector<Trajectory> batch{};
+        std::mt19937 gen(17);
+        std::uniform_int_distribution<int> short_size(50, 500);
+        for (unsigned int i = 0; i < 200; ++i) {
+            batch.emplace_back(synthetic_trajectory(i % 50 == 0 ? 4000 : short_size(gen), i));
+        }
+        std::shuffle(batch.begin(), batch.end(), gen);
+
+        auto start = std::chrono::steady_clock::now();
+        for (auto const& trajectory : batch) {
+            auto levels = mrpa(trajectory);
+        }
+        std::chrono::duration<double> sequential_time = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        auto results = mrpa.simplify_all(batch);
+        std::chrono::duration<double> batch_time = std::chrono::steady_clock::now() - start;
+
+        auto slowest = std::ranges::max_element(results, {}, [](auto const& result) { return result.elapsed; });
+        std::stringstream line;
+        line << std::fixed << std::setprecision(4) << batch.size() << " trajectories on "
+             << concurrency::Work_Stealing_Pool::shared().size() << " workers: sequential " << sequential_time.count()
+             << "s, simplify_all " << batch_time.count() << "s, slowest trajectory "
+             << batch[slowest - results.begin()].size() << " locations in " << slowest->elapsed.count() << "s";
+        logger << line.str();
+    }
+
+    /**
+     * The squared SED error of a simplification with respect to the trajectory it was simplified from.
+     * @param oracle The SED error oracle of the original trajectory.
+     * @param original The original trajectory.
+     * @param simplified A simplification, whose locations are a subsequence of the original locations.
+     */
+    double simplification_error(simp_algorithms::SED_Oracle const& oracle, Trajectory const& original,
+                                Trajectory const& simplified) {
+        double error{};
+        int previous_order{};
+        int order = 1;
+        for (auto const& location : simplified.locations) {
+            while (original[order - 1].timestamp != location.timestamp) {
+                order++;
+            }
+            if (previous_order != 0) {
+                error += oracle(previous_order, order);
+            }
+            previous_order = order;
+        }
+        return error;
+    }
+
+    void benchmark_segmented_mrpa(logging::Logger& logger) {
+        logger << "MRPA whole trajectory vs segmented";
+
+        constexpr double resolution_scale = 1.1;
+        constexpr int trajectory_size = 50000;
+        auto trajectory = synthetic_trajectory(trajectory_size, 11);
+        auto oracle = simp_algorithms::SED_Oracle{trajectory};
+
+        auto whole = simp_algorithms::MRPA{resolution_scale};
+        auto start = std::chrono::steady_clock::now();
+        auto whole_levels = whole(trajectory);
+        std::chrono::duration<double> whole_time = std::chrono::steady_clock::now() - start;
+
+        for (size_t memory_ceiling : {size_t{1} << 20, size_t{1} << 22, size_t{1} << 24}) {
+            auto segmented = simp_algorithms::Segmented_MRPA{resolution_scale, memory_ceiling};
+            start = std::chrono::steady_clock::now();
+            auto segmented_levels = segmented(trajectory);
+            std::chrono::duration<double> segmented_time = std::chrono::steady_clock::now() - start;
+
+            // Compare the coarsest level that both variants produce, along with the finest
+            auto compared_levels = std::min(whole_levels.size(), segmented_levels.size());
+            std::stringstream line;
+            line << std::setprecision(4) << "N = " << trajectory_size << ", ceiling " << (memory_ceiling >> 10)
+                 << " KiB (" << segmented.get_segment_size() << " locations per segment)"
+                 << ": whole " << whole_time.count() << "s (" << whole_levels.size() << " levels)"
+                 << ", segmented " << segmented_time.count() << "s (" << segmented_levels.size() << " levels)"
+                 << ", average compression ratio " << average_compression_ratio(whole_levels, trajectory.size())
+                 << " vs " << average_compression_ratio(segmented_levels, trajectory.size());
+            for (auto level : {size_t{0}, compared_levels - 1}) {
+                line << ", level " << level << " size " << whole_levels[level].size() << " vs "
+                     << segmented_levels[level].size() << " SED error "
+                     << simplification_error(oracle, trajectory, whole_levels[level]) << " vs "
+                     << simplification_error(oracle, trajectory, segmented_levels[level]);
+            }
+            logger << line.str();
+        }
+    }
+
+    logging::Logger get_logger() {
+        auto in_time_t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::stringstream time_ss;
+        time_ss << std::put_time(std::localtime(&in_time_t), "%Y%m%d_%H%M%S");
+        return logging::Logger{"../../logs", "/microbenchmark_" + time_ss.str() + ".txt"};
+    }
+
+}
+
+namespace analytics {
+
+    /**
+     * Times the stages of MRPA in isolation on synthetic trajectories of controlled shape and size, and counts the
+     * heap allocations of every stage. The tree and the approximation are measured for the finest error tolerance
+     * on the original trajectory, which is the most expensive level in cascading mode.
+     */
+    class MRPA_Stage_Benchmark {
+        using MRPA = simp_algorithms::MRPA;
+        using Trajectory = data_structures::Trajectory;
+
+        struct Measurement {
+            double nanoseconds_per_point{};
+            double allocations{};
+        };
+
+        /**
+         * Runs a stage repeatedly, such that every measurement covers at least 10^5 points.
+         * @param stage Callable returning a value derived from its result, which keeps the work from being discarded.
+         * @param points The number of points in the trajectory the stage runs on.
+         * @return The average time per point and the average number of allocations per run.
+         */
+        template<typename F>
+        static Measurement measure(F&& stage, size_t points) {
+            auto repetitions = std::max<size_t>(1, 100000 / points);
+            size_t checksum{};
+
+            auto allocations_before = allocation_count.load();
+            auto start = std::chrono::steady_clock::now();
+            for (size_t repetition = 0; repetition < repetitions; ++repetition) {
+                checksum += static_cast<size_t>(stage());
+            }
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            auto allocations = allocation_count.load() - allocations_before;
+
+            volatile size_t sink = checksum;
+            static_cast<void>(sink);
+            return {elapsed.count() / static_cast<double>(points * repetitions),
+                    static_cast<double>(allocations) / static_cast<double>(repetitions)};
+        }
+
+        static std::string format(std::string const& name, Measurement const& measurement) {
+            std::stringstream result;
+            result << name << " " << std::fixed << std::setprecision(1) << measurement.nanoseconds_per_point
+                   << " ns/point (" << std::setprecision(0) << measurement.allocations << " allocations)";
+            return result.str();
+        }
+
+    public:
+        static void run(logging::Logger& logger) {
+            logger << "MRPA stages in isolation (c = 1.1)";
+
+            constexpr double resolution_scale = 1.1;
+            auto mrpa = MRPA{resolution_scale};
+
+            std::vector<std::pair<std::string, Trajectory (*)(int, unsigned int)>> shapes{
+                    {"random walk", synthetic_trajectory},
+                    {"straight line", straight_line_trajectory},
+                    {"stop-and-go", stop_and_go_trajectory}};
+
+            for (auto const& [shape, generate] : shapes) {
+                for (int trajectory_size : {100, 1000, 10000, 100000}) {
+                    auto trajectory = generate(trajectory_size, 23);
+                    auto points = trajectory.size();
+                    auto oracle = simp_algorithms::SED_Oracle{trajectory};
+                    auto error_tolerances = mrpa.error_tolerance_init(trajectory, oracle);
+                    auto tree = MRPA::apply_error_tolerance_scale_to_tree(trajectory, oracle, 0, error_tolerances);
+
+                    auto oracle_measurement = measure([&]() {
+                        return simp_algorithms::SED_Oracle{trajectory}(1, static_cast<int>(points));
+                    }, points);
+                    auto tolerance_measurement = measure([&]() {
+                        return mrpa.error_tolerance_init(trajectory, oracle).size();
+                    }, points);
+                    auto tree_measurement = measure([&]() {
+                        return MRPA::apply_error_tolerance_scale_to_tree(trajectory, oracle, 0, error_tolerances).size();
+                    }, points);
+                    auto approximate_measurement = measure([&]() {
+                        return MRPA::approximate(trajectory, oracle, tree, error_tolerances[0]).size();
+                    }, points);
+                    auto total_measurement = measure([&]() {
+                        return mrpa(trajectory).size();
+                    }, points);
+
+                    logger << shape + ", N = " + std::to_string(points) + ": "
+                              + format("oracle", oracle_measurement) + ", "
+                              + format("error_tolerance_init", tolerance_measurement) + ", "
+                              + format("init_tree", tree_measurement) + ", "
+                              + format("approximate", approximate_measurement) + ", "
+                              + format("operator()", total_measurement);
+                }
+            }
+        }
+    };
+
+} // analytics
+
+int main() {
+    auto logger = get_logger();
+    analytics::MRPA_Stage_Benchmark::run(logger);
+    benchmark_sed_oracle(logger);
+    benchmark_mrpa_modes(logger);
+    benchmark_error_metrics(logger);
+    benchmark_segmented_mrpa(logger);
+    benchmark_batch(logger);
+    benchmark_candidate_generators(logger);
+    return 0;
+}
@@ -1,6 +1,9 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "TRACE_Q_Benchmark.hpp"
 #include "../simp-algorithms/TRACE_Q.hpp"
+#include "../simp-algorithms/TD_TR.hpp"
+#include "../simp-algorithms/SQUISH_E.hpp"
+#include "../simp-algorithms/OPW.hpp"
 #include "../trajectory_data_handling/Trajectory_Manager.hpp"
 #include "../trajectory_data_handling/File_Manager.hpp"
 #include "Benchmark.hpp"
@@ -37,6 +40,7 @@ namespace analytics {
 
         TRACE_Q_Benchmark::traceq_hardcore_query_accuracy(amount_of_test_trajectories, file_logger);
         TRACE_Q_Benchmark::mrpa_benchmark(amount_of_test_trajectories, file_logger);
+        TRACE_Q_Benchmark::traceq_candidate_generators(amount_of_test_trajectories, file_logger);
     }
 
     void TRACE_Q_Benchmark::traceq_is_knn_necessary(std::vector<std::shared_ptr<Benchmark_Query>> const& query_objects,
@@ -979,6 +983,67 @@ namespace analytics {
         }
     }
 
+    void TRACE_Q_Benchmark::traceq_candidate_generators(int amount_of_test_trajectories, logging::Logger & logger) {
+
+        logger << "TRACE-Q Candidate Generators\n";
+
+        double resolution_scale = 1.1;
+
+        TRACE_Q_Benchmark::run_traceq_candidate_generator_benchmark(
+                "MRPA", simp_algorithms::MRPA{resolution_scale}, amount_of_test_trajectories, logger);
+        TRACE_Q_Benchmark::run_traceq_candidate_generator_benchmark(
+                "TD-TR", simp_algorithms::TD_TR{resolution_scale}, amount_of_test_trajectories, logger);
+        TRACE_Q_Benchmark::run_traceq_candidate_generator_benchmark(
+                "SQUISH-E", simp_algorithms::SQUISH_E{resolution_scale}, amount_of_test_trajectories, logger);
+        TRACE_Q_Benchmark::run_traceq_candidate_generator_benchmark(
+                "OPW", simp_algorithms::OPW{resolution_scale}, amount_of_test_trajectories, logger);
+    }
+
+    void TRACE_Q_Benchmark::run_traceq_candidate_generator_benchmark(
+            std::string const& generator_name, trace_q::TRACE_Q::Simplifier const& generator,
+            int amount_of_test_trajectories, logging::Logger & logger) {
+        trajectory_data_handling::Trajectory_Manager::reset_all_data();
+        trajectory_data_handling::File_Manager::load_tdrive_dataset(amount_of_test_trajectories);
+
+        const auto query_objects = analytics::Benchmark::initialize_query_objects();
+
+        double resolution_scale = 1.1;
+        double min_range_query_accuracy = 0.95;
+        double min_knn_query_accuracy = 0.95;
+        int max_trajectories_in_batch = 8;
+        int max_threads = 50;
+        auto range_query_grid_density = 0.1;
+        auto knn_query_grid_density = 0.1;
+        int windows_per_grid_point = 3;
+        double window_expansion_rate = 1.3;
+        double range_query_time_interval_multiplier = 0.1;
+        double knn_query_time_interval_multiplier = 0.1;
+        int knn_k = 10;
+        bool use_KNN_for_query_accuracy = true;
+
+        auto trace_q = trace_q::TRACE_Q{resolution_scale, min_range_query_accuracy, min_knn_query_accuracy,
+                                        max_trajectories_in_batch, max_threads,
+                                        range_query_grid_density,
+                                        knn_query_grid_density, windows_per_grid_point,
+                                        window_expansion_rate, range_query_time_interval_multiplier,
+                                        knn_query_time_interval_multiplier, knn_k,
+                                        use_KNN_for_query_accuracy, false, generator};
+
+        auto time = analytics::Benchmark::function_time([&trace_q]() { trace_q.run(); });
+
+        auto query_accuracy = analytics::Benchmark::benchmark_query_accuracy(query_objects);
+
+        std::stringstream log;
+
+        log << "TRACE-Q with " << generator_name << " candidates, Minimum Accuracy: " << min_range_query_accuracy << "\n";
+        log << "Resolution Scale: " << std::to_string(resolution_scale) << "\n";
+        log << "Benchmark:\n";
+        log << "Runtime: " << time / 1000 << " s\n";
+        log << "Range Query Accuracy: " << query_accuracy.range_f1 << "\n";
+        log << "KNN Query Accuracy: " << query_accuracy.knn_f1 << "\n";
+        log << "Compression Ratio: " << analytics::Benchmark::get_compression_ratio() << "\n";
+        logger << log.str();
+    }
 
     void TRACE_Q_Benchmark::mrpa_benchmark(int amount_of_test_trajectories, logging::Logger & logger) {
         logger << "MRPA benchmarking\n";
@@ -5,6 +5,7 @@
 #include "benchmark-query-objects/Benchmark_Query.hpp"
 #include "../logging/Logger.hpp"
 #include "../simp-algorithms/MRPA.hpp"
+#include "../simp-algorithms/TRACE_Q.hpp"
 
 namespace analytics {
 
@@ -25,6 +26,10 @@ namespace analytics {
         static void traceq_knn_k(std::vector<std::shared_ptr<Benchmark_Query>> const& query_objects,
                                  logging::Logger & logger);
         static void traceq_hardcore_query_accuracy(int amount_of_test_trajectories, logging::Logger & logger);
+        static void traceq_candidate_generators(int amount_of_test_trajectories, logging::Logger & logger);
+        static void run_traceq_candidate_generator_benchmark(std::string const& generator_name,
+                                                             trace_q::TRACE_Q::Simplifier const& generator,
+                                                             int amount_of_test_trajectories, logging::Logger & logger);
         static void run_mrpa(simp_algorithms::MRPA mrpa, std::vector<unsigned int> const & all_ids, double mrpa_error);
         static void mrpa_benchmark(int amount_of_test_trajectories, logging::Logger & logger);
         static void run_mrpa_benchmark(double mrpa_error, int amount_of_test_trajectories, int tests_per_accuracy,
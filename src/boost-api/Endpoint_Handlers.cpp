@@ -1,14 +1,40 @@
+#include <atomic>
 #include "Endpoint_Handlers.hpp"
 #include "boost/json/src.hpp"
 #include "boost/json/stream_parser.hpp"
 #include "../trajectory_data_handling/Trajectory_Manager.hpp"
 #include "../trajectory_data_handling/File_Manager.hpp"
 #include "TRACE_Q.hpp"
+#include "Run_Metrics.hpp"
+#include "TD_TR.hpp"
+#include "SQUISH_E.hpp"
+#include "OPW.hpp"
 
 namespace api {
     using namespace boost::beast::http;
     using namespace trajectory_data_handling;
 
+    namespace {
+        /**
+         * Whether a simplification run is in progress. Concurrent runs would replace each other's simplifications of
+         * the same trajectories, compete for the database connections and reset each other's metrics.
+         */
+        std::atomic<bool> run_in_progress{false};
+
+        /**
+         * Ends the run in progress when the run request has been handled, also if it failed.
+         */
+        struct Run_Guard {
+            Run_Guard() = default;
+            Run_Guard(Run_Guard const&) = delete;
+            Run_Guard& operator=(Run_Guard const&) = delete;
+
+            ~Run_Guard() {
+                run_in_progress.store(false);
+            }
+        };
+    }
+
     void add_cors_headers(response<string_body> &res) {
         res.set(field::access_control_allow_origin, "*");  // You can replace * with the specific origin you want to allow
         res.set(field::access_control_allow_methods, "GET, POST, PUT, DELETE, OPTIONS");
@@ -65,6 +91,39 @@ namespace api {
         return json_traj;
     }
 
+    boost::json::object convert_run_metrics_to_json(const trace_q::Run_Metrics::Snapshot& snapshot) {
+        boost::json::object json_run{};
+        json_run["running"] = snapshot.running;
+        json_run["elapsed_seconds"] = snapshot.elapsed_seconds;
+        json_run["trajectories"] = snapshot.trajectories;
+        json_run["trajectories_simplified"] = snapshot.trajectories_simplified;
+        json_run["trajectories_kept"] = snapshot.trajectories_kept;
+
+        boost::json::object json_stages{};
+        for (size_t i = 0; i < trace_q::Run_Metrics::stage_count; ++i) {
+            boost::json::object json_stage{};
+            json_stage["total_seconds"] = snapshot.stages[i].total_seconds;
+            json_stage["mean_seconds_per_trajectory"] = snapshot.stages[i].mean_seconds_per_trajectory;
+            json_stage["max_seconds"] = snapshot.stages[i].max_seconds;
+            json_stages[trace_q::Run_Metrics::stage_name(static_cast<trace_q::Run_Metrics::Stage>(i))] =
+                    std::move(json_stage);
+        }
+        json_run["stages"] = std::move(json_stages);
+
+        json_run["query_objects_generated"] = snapshot.query_objects_generated;
+        json_run["query_tests_evaluated"] = snapshot.query_tests_evaluated;
+        json_run["query_tests_updated"] = snapshot.query_tests_updated;
+        json_run["levels_tried"] = snapshot.levels_tried;
+
+        boost::json::array json_chosen_levels{};
+        for (auto count : snapshot.chosen_levels) {
+            json_chosen_levels.push_back(count);
+        }
+        json_run["chosen_levels"] = std::move(json_chosen_levels);
+
+        return json_run;
+    }
+
     double get_double_value(boost::json::value value) {
         if(value.is_int64()) {
             auto value_int = value.as_int64();
@@ -73,6 +132,30 @@ namespace api {
         return value.as_double();
     }
 
+    /**
+     * Creates the simplifier named by the optional "simplifier" key of a run request.
+     * An absent key or "mrpa" selects the default, MRPA with the TRACE_Q resolution scale.
+     */
+    trace_q::TRACE_Q::Simplifier get_simplifier(const boost::json::object &json_object, double resolution_scale) {
+        if (!json_object.contains("simplifier")) {
+            return {};
+        }
+        auto name = std::string{json_object.at("simplifier").as_string()};
+        if (name == "mrpa") {
+            return {};
+        }
+        if (name == "td_tr") {
+            return simp_algorithms::TD_TR{resolution_scale};
+        }
+        if (name == "squish_e") {
+            return simp_algorithms::SQUISH_E{resolution_scale};
+        }
+        if (name == "opw") {
+            return simp_algorithms::OPW{resolution_scale};
+        }
+        throw std::invalid_argument("Unknown simplifier: " + name);
+    }
+
     /**
          This endpoint handles insertion of a trajectory into a specified database table. Works with JSON formatted as:
 
@@ -443,9 +526,23 @@ namespace api {
             "range_query_time_interval" : 0.2,
             "knn_query_time_interval" : 0.2,
             "knn_k" : 10,
-            "use_KNN_for_query_accuracy" : true
+            "use_KNN_for_query_accuracy" : true,
+            "use_tolerance_bisection" : false,
+            "simplifier" : "mrpa",
+            "use_knn_index" : false,
+            "incremental" : false
         }
 
+         The "use_tolerance_bisection" key is optional and defaults to false.
+         The "simplifier" key is optional and selects the candidate generator: "mrpa" (default), "td_tr", "squish_e"
+         or "opw". Tolerance bisection is only supported with "mrpa".
+         The "use_knn_index" key is optional and defaults to false. If true, the original trajectories are loaded into
+         memory once, and the KNN queries of the query tests are answered from there instead of by the database.
+         The "incremental" key is optional and defaults to false. If true, only the original trajectories that have not
+         been simplified with the same parameters, or that have changed since, are simplified. This also resumes an
+         interrupted run.
+         Only one run is performed at a time. A request made while a run is in progress is answered with 409 Conflict,
+         and the progress of the run can be polled on /status.
     */
     void handle_run_simplification(const request<string_body> &req, response<string_body> &res) {
         try {
@@ -455,15 +552,24 @@ namespace api {
             }
             add_cors_headers(res);
 
+            if (run_in_progress.exchange(true)) {
+                res.result(status::conflict);
+                res.set(field::content_type, "text/plain");
+                res.body() = "A simplification run is already in progress";
+                return;
+            }
+            Run_Guard run_guard{};
+
             boost::json::value json_data = boost::json::parse(req.body());
 
             if (!json_data.is_object())
                 throw std::runtime_error("Invalid JSON data: expected an object");
 
             const boost::json::object &json_object = json_data.as_object();
+            auto resolution_scale = get_double_value(json_object.at("resolution_scale"));
 
             trace_q::TRACE_Q trace_q{
-                    get_double_value(json_object.at("resolution_scale")),
+                    resolution_scale,
                     get_double_value(json_object.at("min_range_query_accuracy")),
                     get_double_value(json_object.at("min_knn_query_accuracy")),
                 static_cast<int>(json_object.at("max_trajectories_in_batch").as_int64()),
@@ -475,14 +581,23 @@ namespace api {
                     get_double_value(json_object.at("range_query_time_interval")),
                     get_double_value(json_object.at("knn_query_time_interval")),
                 static_cast<int>(json_object.at("knn_k").as_int64()),
-                json_object.at("use_KNN_for_query_accuracy").as_bool()
+                json_object.at("use_KNN_for_query_accuracy").as_bool(),
+                json_object.contains("use_tolerance_bisection") && json_object.at("use_tolerance_bisection").as_bool(),
+                get_simplifier(json_object, resolution_scale)
             };
 
-            trace_q.run();
+            if (json_object.contains("use_knn_index") && json_object.at("use_knn_index").as_bool()) {
+                trace_q.use_knn_index(std::make_shared<spatial_queries::KNN_Index const>(
+                        spatial_queries::KNN_Index::load(trajectory_data_handling::Trajectory_Manager::get_table_name(
+                                trajectory_data_handling::db_table::original_trajectories))));
+            }
+
+            auto incremental = json_object.contains("incremental") && json_object.at("incremental").as_bool();
+            auto stats = trace_q.run(incremental);
 
             res.result(boost::beast::http::status::ok);
             res.set(boost::beast::http::field::content_type, "text/plain");
-            res.body() = "Simplification process completed successfully";
+            res.body() = "Simplification process completed successfully\n" + stats.to_string();
         }
         catch (const std::exception &e) {
             res.result(boost::beast::http::status::bad_request);
@@ -492,14 +607,49 @@ namespace api {
     }
     /**
      This endpoint checks that there are the same amount of trajectories in both the original_trajectories and simplified_trajectories databases. No body is needed for this endpoint.
+     It also reports the progress of the latest simplification run, which can be polled while the run is in progress:
+
+     {
+        "db_status" : true,
+        "run" : {
+            "running" : true,
+            "elapsed_seconds" : 12.5,
+            "trajectories" : 100,
+            "trajectories_simplified" : 40,
+            "trajectories_kept" : 2,
+            "stages" : {
+                "candidate_generation" : { "total_seconds" : 1.2, "mean_seconds_per_trajectory" : 0.03, "max_seconds" : 0.2 },
+                "query_initialization" : { ... },
+                "query_evaluation" : { ... },
+                "load" : { ... },
+                "insert" : { ... }
+            },
+            "query_objects_generated" : 120000,
+            "query_tests_evaluated" : 45000,
+            "query_tests_updated" : 8000,
+            "levels_tried" : 160,
+            "chosen_levels" : [0, 3, 20, 15]
+        }
+     }
+
+     The stage times are summed over the simplification workers. "query_tests_evaluated" counts the query tests evaluated
+     on a whole candidate, and "query_tests_updated" those re-checked when moving from one MRPA level to the next.
+     "chosen_levels" counts the trajectories for which each
+     level was accepted, and "trajectories_kept" those for which none was.
      */
     void handle_db_status(const request<string_body> &req, response<string_body> &res) {
         try {
             bool db_status = trajectory_data_handling::Trajectory_Manager::get_db_status();
 
+            boost::json::object response_object{};
+            response_object["db_status"] = db_status;
+            response_object["run"] = convert_run_metrics_to_json(trace_q::Run_Metrics::shared().snapshot());
+
             res.result(boost::beast::http::status::ok);
-            res.set(boost::beast::http::field::content_type, "text/plain");
-            res.body() = db_status ? "true" : "false";
+            res.set(boost::beast::http::field::content_type, "application/json");
+            std::stringstream ss{};
+            ss << response_object;
+            res.body() = ss.str();
         } catch(const std::exception &e) {
             res.result(boost::beast::http::status::bad_request);
             res.set(boost::beast::http::field::content_type, "text/plain");
@@ -1,19 +1,20 @@
+#include <algorithm>
+#include <condition_variable>
+#include <csignal>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
 #include "Start_API.hpp"
 
 namespace api {
-    // Function to run the server
-    void run(boost::asio::ip::tcp::acceptor &acceptor, std::map<std::string, api::RequestHandler> &endpoints) {
-        // Set up the io_context
-        boost::asio::io_context io_context{};
-
-        // Accept incoming connections in a loop
-        while (true) {
-            // Create a socket
-            boost::asio::ip::tcp::socket socket(io_context);
-
-            // Wait for and accept a connection
-            acceptor.accept(socket);
+    namespace {
+        using boost::asio::ip::tcp;
 
+        // Function to serve the requests of a connection until it is closed
+        void serve(tcp::socket& socket, std::map<std::string, api::RequestHandler> const &endpoints) {
             // Declare the error_code variable here
             boost::system::error_code ec{};
 
@@ -24,7 +25,7 @@ namespace api {
                 boost::beast::http::read(socket, buffer, request, ec);
 
                 if (ec) {
-                    break;  // Break the inner loop if error occurs (e.g., connection closed by client)
+                    break;  // Break the loop if error occurs (e.g., connection closed by client)
                 }
 
                 // Prepare an HTTP response
@@ -41,13 +42,131 @@ namespace api {
                 // Send the response
                 boost::beast::http::write(socket, response, ec);
                 if (ec || response.need_eof()) {
-                    break;  // Break the inner loop if error occurs or if it's the last response
+                    break;  // Break the loop if error occurs or if it's the last response
+                }
+            }
+        }
+
+        /**
+         * The accepted connections that wait for a server thread, and the connections that are being served.
+         */
+        class Connections {
+            std::mutex mutex{};
+            std::condition_variable available{};
+            std::deque<tcp::socket> waiting{};
+            std::vector<tcp::socket*> served{};
+            bool closed{false};
+
+        public:
+            void push(tcp::socket socket) {
+                {
+                    std::lock_guard lock{mutex};
+                    waiting.push_back(std::move(socket));
+                }
+                available.notify_one();
+            }
+
+            /**
+             * Waits for a connection to serve.
+             * @return The connection, or nothing if the connections are closed and no connection is waiting.
+             */
+            std::optional<tcp::socket> pop() {
+                std::unique_lock lock{mutex};
+                available.wait(lock, [this]() { return closed || !waiting.empty(); });
+                if (waiting.empty()) {
+                    return std::nullopt;
+                }
+                auto socket = std::move(waiting.front());
+                waiting.pop_front();
+                return socket;
+            }
+
+            void begin_serving(tcp::socket& socket) {
+                std::lock_guard lock{mutex};
+                served.push_back(&socket);
+                if (closed) {
+                    boost::system::error_code ec{};
+                    socket.shutdown(tcp::socket::shutdown_receive, ec);
+                }
+            }
+
+            void end_serving(tcp::socket& socket) {
+                std::lock_guard lock{mutex};
+                std::erase(served, &socket);
+            }
+
+            /**
+             * Stops reading new requests from every connection, so the server threads finish once the requests they
+             * are handling have been answered.
+             */
+            void close() {
+                {
+                    std::lock_guard lock{mutex};
+                    closed = true;
+                    boost::system::error_code ec{};
+                    for (auto socket : served) {
+                        socket->shutdown(tcp::socket::shutdown_receive, ec);
+                    }
+                    for (auto& socket : waiting) {
+                        socket.shutdown(tcp::socket::shutdown_receive, ec);
+                    }
                 }
+                available.notify_all();
             }
+        };
+
+        void accept_next(tcp::acceptor &acceptor, Connections &connections) {
+            acceptor.async_accept([&acceptor, &connections](boost::system::error_code ec, tcp::socket socket) {
+                if (!acceptor.is_open()) {
+                    return;  // The server is shutting down
+                }
+                if (!ec) {
+                    connections.push(std::move(socket));
+                }
+                accept_next(acceptor, connections);
+            });
+        }
+    }
 
-            // Gracefully close the socket
-            socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
-            socket.close(ec);
+    // Function to run the server
+    void run(boost::asio::io_context &io_context, boost::asio::ip::tcp::acceptor &acceptor,
+             std::map<std::string, api::RequestHandler> &endpoints, size_t server_threads) {
+        Connections connections{};
+
+        // Every server thread serves one connection at a time, so that /status answers while /run is in progress
+        std::vector<std::jthread> servers{};
+        for (size_t i = 0; i < std::max(server_threads, size_t{1}); ++i) {
+            servers.emplace_back([&connections, &endpoints]() {
+                while (auto socket = connections.pop()) {
+                    connections.begin_serving(*socket);
+                    try {
+                        serve(*socket, endpoints);
+                    }
+                    catch (const std::exception &e) {
+                        std::cerr << "Error serving connection: " << e.what() << '\n';
+                    }
+                    connections.end_serving(*socket);
+
+                    // Gracefully close the socket
+                    boost::system::error_code ec{};
+                    socket->shutdown(tcp::socket::shutdown_both, ec);
+                    socket->close(ec);
+                }
+            });
         }
+
+        // Stop accepting connections on SIGINT or SIGTERM
+        boost::asio::signal_set signals{io_context, SIGINT, SIGTERM};
+        signals.async_wait([&acceptor](boost::system::error_code, int) {
+            boost::system::error_code ec{};
+            acceptor.close(ec);
+        });
+
+        // Accept incoming connections until the server is stopped
+        accept_next(acceptor, connections);
+        io_context.run();
+
+        // Let the server threads answer the requests they are handling, such as a run in progress, and stop
+        connections.close();
     }
 }
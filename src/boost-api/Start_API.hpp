@@ -7,6 +7,15 @@
 #include "Endpoint_Handlers.hpp"
 
 namespace api {
-// Function to run the server
-    void run(boost::asio::ip::tcp::acceptor &acceptor, std::map<std::string, api::RequestHandler> &endpoints);
+    /**
+     * Serves the connections of the acceptor until the process receives SIGINT or SIGTERM. Each of the server threads
+     * serves one connection at a time, and further connections wait for a server thread to become free.
+     * On shutdown, the requests being handled are answered before the server threads stop.
+     * @param io_context The context of the acceptor, which is run on the calling thread.
+     * @param acceptor The acceptor that listens for incoming connections.
+     * @param endpoints The handlers of the endpoints.
+     * @param server_threads The number of connections that are served at the same time.
+     */
+    void run(boost::asio::io_context &io_context, boost::asio::ip::tcp::acceptor &acceptor,
+             std::map<std::string, api::RequestHandler> &endpoints, size_t server_threads = 8);
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#ifndef TRACE_Q_BOUNDED_QUEUE_HPP
+#define TRACE_Q_BOUNDED_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace concurrency {
+
+    /**
+     * A lock-free multi-producer multi-consumer queue of fixed capacity, after Dmitry Vyukov's bounded MPMC queue.
+     * Every cell of a ring buffer carries a sequence number, which tells producers and consumers whether the cell is
+     * free for the current lap or holds a value of it. A push or pop claims its position with a single compare and
+     * swap, and neither blocks: they fail when the queue is full or empty.
+     * @tparam T The type of the values, which must be nothrow move constructible.
+     */
+    template<typename T>
+    class Bounded_Queue {
+        static_assert(std::is_nothrow_move_constructible_v<T>);
+
+        struct Cell {
+            std::atomic<size_t> sequence{};
+            alignas(T) std::byte storage[sizeof(T)];
+
+            T* value() {
+                return std::launder(reinterpret_cast<T*>(storage));
+            }
+        };
+
+        /**
+         * Keeps the positions of producers and consumers on separate cache lines.
+         */
+        static constexpr size_t cache_line_size{64};
+
+        std::unique_ptr<Cell[]> cells;
+        size_t const mask;
+        alignas(cache_line_size) std::atomic<size_t> enqueue_position{0};
+        alignas(cache_line_size) std::atomic<size_t> dequeue_position{0};
+
+    public:
+        /**
+         * @param capacity The maximum number of values in the queue, which is rounded up to a power of two of at
+         * least two.
+         */
+        explicit Bounded_Queue(size_t capacity)
+                : cells{std::make_unique<Cell[]>(std::bit_ceil(std::max(capacity, size_t{2})))},
+                  mask{std::bit_ceil(std::max(capacity, size_t{2})) - 1} {
+            for (size_t i = 0; i <= mask; ++i) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        Bounded_Queue(Bounded_Queue const&) = delete;
+        Bounded_Queue& operator=(Bounded_Queue const&) = delete;
+
+        ~Bounded_Queue() {
+            while (try_pop()) {}
+        }
+
+        /**
+         * Appends a value unless the queue is full.
+         * @param value The value, which is only moved from if it is appended.
+         * @return Whether the value was appended.
+         */
+        bool try_push(T&& value) {
+            auto position = enqueue_position.load(std::memory_order_relaxed);
+            Cell* cell{};
+            while (true) {
+                cell = &cells[position & mask];
+                auto sequence = cell->sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+                if (difference == 0) {
+                    if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (difference < 0) {
+                    return false; // The cell still holds the value of the previous lap
+                }
+                else {
+                    position = enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+            ::new (cell->storage) T(std::move(value));
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Removes the oldest value unless the queue is empty.
+         * @return The value, or nothing if the queue is empty.
+         */
+        std::optional<T> try_pop() {
+            auto position = dequeue_position.load(std::memory_order_relaxed);
+            Cell* cell{};
+            while (true) {
+                cell = &cells[position & mask];
+                auto sequence = cell->sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+                if (difference == 0) {
+                    if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (difference < 0) {
+                    return std::nullopt; // The cell has not been filled in this lap
+                }
+                else {
+                    position = dequeue_position.load(std::memory_order_relaxed);
+                }
+            }
+            std::optional<T> result{std::move(*cell->value())};
+            cell->value()->~T();
+            cell->sequence.store(position + mask + 1, std::memory_order_release);
+            return result;
+        }
+
+        /**
+         * @return The number of values in the queue, which is only a snapshot while other threads use it.
+         */
+        [[nodiscard]] size_t size() const {
+            auto dequeued = dequeue_position.load(std::memory_order_relaxed);
+            auto enqueued = enqueue_position.load(std::memory_order_relaxed);
+            return enqueued > dequeued ? std::min(enqueued - dequeued, capacity()) : 0;
+        }
+
+        [[nodiscard]] size_t capacity() const {
+            return mask + 1;
+        }
+    };
+
+} // concurrency
+
+#endif //TRACE_Q_BOUNDED_QUEUE_HPP
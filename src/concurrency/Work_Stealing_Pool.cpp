@@ -0,0 +1,112 @@
+#include "Work_Stealing_Pool.hpp"
+
+namespace concurrency {
+
+    namespace {
+        /**
+         * The pool and queue index of the worker running on the current thread, if any.
+         */
+        thread_local Work_Stealing_Pool const* current_pool{nullptr};
+        thread_local size_t current_index{};
+    }
+
+    Work_Stealing_Pool::Work_Stealing_Pool(unsigned int thread_count) {
+        if (thread_count == 0) {
+            thread_count = 1;
+        }
+        queues.reserve(thread_count);
+        for (unsigned int i = 0; i < thread_count; ++i) {
+            queues.emplace_back(std::make_unique<Worker_Queue>());
+        }
+        workers.reserve(thread_count);
+        for (unsigned int i = 0; i < thread_count; ++i) {
+            workers.emplace_back(&Work_Stealing_Pool::work, this, i);
+        }
+    }
+
+    Work_Stealing_Pool::~Work_Stealing_Pool() {
+        {
+            std::scoped_lock lock{wake_mutex};
+            stopping = true;
+        }
+        tasks_available.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    Work_Stealing_Pool& Work_Stealing_Pool::shared() {
+        static Work_Stealing_Pool pool{};
+        return pool;
+    }
+
+    void Work_Stealing_Pool::push(std::function<void()> task) {
+        auto index = current_pool == this ? current_index : next_queue++ % queues.size();
+        {
+            std::scoped_lock lock{queues[index]->mutex};
+            queues[index]->tasks.emplace_back(std::move(task));
+            queued++;
+        }
+        {
+            // Taking the lock orders the notification after a worker that saw no tasks has started waiting
+            std::scoped_lock lock{wake_mutex};
+        }
+        tasks_available.notify_one();
+    }
+
+    bool Work_Stealing_Pool::is_worker_thread() const {
+        return current_pool == this;
+    }
+
+    bool Work_Stealing_Pool::run_pending_task() {
+        if (auto task = take(current_index)) {
+            (*task)();
+            return true;
+        }
+        return false;
+    }
+
+    std::optional<std::function<void()>> Work_Stealing_Pool::take(size_t index) {
+        {
+            auto& own = *queues[index];
+            std::scoped_lock lock{own.mutex};
+            if (!own.tasks.empty()) {
+                auto task = std::move(own.tasks.front());
+                own.tasks.pop_front();
+                queued--;
+                return task;
+            }
+        }
+        for (size_t offset = 1; offset < queues.size(); ++offset) {
+            auto& victim = *queues[(index + offset) % queues.size()];
+            std::scoped_lock lock{victim.mutex};
+            if (!victim.tasks.empty()) {
+                // The oldest task is the largest when tasks are submitted in order of decreasing cost, and taking it
+                // first keeps the thief from ending up with the last long task
+                auto task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queued--;
+                return task;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void Work_Stealing_Pool::work(size_t index) {
+        current_pool = this;
+        current_index = index;
+        while (true) {
+            if (auto task = take(index)) {
+                (*task)();
+                continue;
+            }
+
+            std::unique_lock lock{wake_mutex};
+            tasks_available.wait(lock, [this]() { return stopping || queued > 0; });
+            if (stopping && queued == 0) {
+                return; // Stopping and no work is left
+            }
+        }
+    }
+
+} // concurrency
@@ -0,0 +1,186 @@
+#ifndef TRACE_Q_WORK_STEALING_POOL_HPP
+#define TRACE_Q_WORK_STEALING_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace concurrency {
+
+    /**
+     * A fixed number of worker threads, each with its own task queue.
+     * Tasks are distributed over the queues round-robin, and every worker executes its own queue in submission order.
+     * A worker whose queue is empty steals the oldest task from another worker's queue, so that a few long tasks on
+     * one worker do not leave the other workers idle. Batches submitted in order of decreasing cost, like
+     * simplify_all, thus have their largest pending task stolen first. Tasks submitted from a worker thread go to that
+     * worker's own queue.
+     * Tasks may submit tasks of their own and wait for them with wait, get or parallel_for, since a waiting worker
+     * executes queued tasks instead of blocking.
+     */
+    class Work_Stealing_Pool {
+        struct Worker_Queue {
+            std::mutex mutex{};
+            std::deque<std::function<void()>> tasks{};
+        };
+
+        std::vector<std::unique_ptr<Worker_Queue>> queues{};
+        std::vector<std::thread> workers{};
+
+        /**
+         * The number of tasks that are queued but not yet taken by a worker. It only changes under the lock of the
+         * queue the task is added to or taken from, so a task is counted before it can be taken.
+         */
+        std::atomic<size_t> queued{0};
+        std::atomic<size_t> next_queue{0};
+        std::mutex wake_mutex{};
+        std::condition_variable tasks_available{};
+        bool stopping{false};
+
+        /**
+         * The loop run by every worker thread. Workers exit once the pool is stopping and no tasks remain.
+         * @param index The index of the worker's own queue.
+         */
+        void work(size_t index);
+
+        /**
+         * Takes the next task of the given worker, stealing from the other workers if its own queue is empty.
+         * @param index The index of the worker's own queue.
+         * @return The task, or nothing if every queue is empty.
+         */
+        std::optional<std::function<void()>> take(size_t index);
+
+        /**
+         * Adds a task to the queue of the calling worker, or to the next queue in round-robin order.
+         */
+        void push(std::function<void()> task);
+
+        /**
+         * @return Whether the calling thread is one of the pool's workers.
+         */
+        [[nodiscard]] bool is_worker_thread() const;
+
+        /**
+         * Executes one queued task on the calling worker thread, preferring the worker's own queue.
+         * @return Whether a task was executed.
+         */
+        bool run_pending_task();
+
+    public:
+        /**
+         * Starts the worker threads.
+         * @param thread_count The number of worker threads. Zero is replaced by one.
+         */
+        explicit Work_Stealing_Pool(unsigned int thread_count = std::thread::hardware_concurrency());
+
+        /**
+         * Finishes the queued tasks and joins the worker threads.
+         */
+        ~Work_Stealing_Pool();
+
+        Work_Stealing_Pool(Work_Stealing_Pool const&) = delete;
+        Work_Stealing_Pool& operator=(Work_Stealing_Pool const&) = delete;
+
+        /**
+         * The work-stealing pool shared by the whole process, sized to the hardware concurrency.
+         */
+        static Work_Stealing_Pool& shared();
+
+        /**
+         * Queues a task for execution on one of the worker threads.
+         * @param func The task to execute.
+         * @param args The arguments the task is invoked with. They are copied or moved into the task.
+         * @return A future holding the result of the task, or the exception it threw.
+         */
+        template<typename F, typename... Args>
+        auto submit(F&& func, Args&&... args) -> std::future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>> {
+            using Result = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+
+            // std::function must be copyable, so the packaged task is shared
+            auto task = std::make_shared<std::packaged_task<Result()>>(
+                    [func = std::forward<F>(func), ... args = std::forward<Args>(args)]() mutable {
+                        return std::invoke(func, args...);
+                    });
+            auto result = task->get_future();
+            push([task]() { (*task)(); });
+            return result;
+        }
+
+        /**
+         * Waits until the future is ready. On a worker thread of the pool, queued tasks are executed while waiting,
+         * so a task can wait for the tasks it submitted without occupying a worker.
+         */
+        template<typename T>
+        void wait(std::future<T> const& future) {
+            if (!is_worker_thread()) {
+                future.wait();
+                return;
+            }
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if (!run_pending_task()) {
+                    // The awaited task is running on another worker
+                    future.wait_for(std::chrono::microseconds(50));
+                }
+            }
+        }
+
+        /**
+         * Waits until the future is ready like wait, and returns its result.
+         * @return The result of the task, or the exception it threw is rethrown.
+         */
+        template<typename T>
+        T get(std::future<T>& future) {
+            wait(future);
+            return future.get();
+        }
+
+        /**
+         * Calls func(chunk_begin, chunk_end) for consecutive chunks that cover [begin, end), concurrently, and waits
+         * for all of them. There are about four chunks per worker, which amortizes the cost of a task over many
+         * cheap iterations while still balancing uneven ones.
+         * @param begin The first index.
+         * @param end One past the last index.
+         * @param func The callable processing a chunk of indices.
+         * @throws The first exception thrown by func, once every chunk has finished.
+         */
+        template<typename F>
+        void parallel_for(size_t begin, size_t end, F&& func) {
+            if (begin >= end) {
+                return;
+            }
+            auto chunk_count = std::min(end - begin, 4 * size());
+            auto chunk_size = (end - begin + chunk_count - 1) / chunk_count;
+
+            std::vector<std::future<void>> futures{};
+            futures.reserve(chunk_count);
+            for (auto chunk_begin = begin; chunk_begin < end; chunk_begin += chunk_size) {
+                auto chunk_end = std::min(end, chunk_begin + chunk_size);
+                futures.emplace_back(submit([&func, chunk_begin, chunk_end]() { func(chunk_begin, chunk_end); }));
+            }
+
+            // Every chunk refers to func, so all of them must finish before an exception leaves this scope
+            for (auto& future : futures) {
+                wait(future);
+            }
+            for (auto& future : futures) {
+                future.get();
+            }
+        }
+
+        [[nodiscard]] size_t size() const {
+            return workers.size();
+        }
+    };
+
+} // concurrency
+
+#endif //TRACE_Q_WORK_STEALING_POOL_HPP
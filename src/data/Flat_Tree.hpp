@@ -0,0 +1,103 @@
+#ifndef TRACE_Q_FLAT_TREE_HPP
+#define TRACE_Q_FLAT_TREE_HPP
+
+#include <vector>
+#include <span>
+#include <stdexcept>
+
+namespace data_structures {
+
+    /**
+     * A tree over the point orders 1..n of a trajectory, stored in flat arrays instead of linked nodes.
+     * Children are kept in compressed sparse row form: the children of a vertex occupy one contiguous range of a
+     * shared array, so a vertex must receive all of its children before the next vertex receives any.
+     * Parent lookups are constant time and no memory is allocated per vertex.
+     */
+    class Flat_Tree {
+        /**
+         * parents[order - 1] is the parent of the vertex, or 0 if the vertex is the root or not in the tree.
+         */
+        std::vector<int> parents{};
+
+        /**
+         * child_offsets[order - 1] is the index into children where the children of the vertex start.
+         */
+        std::vector<int> child_offsets{};
+
+        /**
+         * child_counts[order - 1] is the number of children of the vertex.
+         */
+        std::vector<int> child_counts{};
+
+        /**
+         * The orders of the children of every vertex, grouped by parent.
+         */
+        std::vector<int> children{};
+
+        int root_order{};
+
+    public:
+        Flat_Tree() = default;
+
+        /**
+         * Creates a tree consisting of only the root.
+         * @param root The order of the root vertex.
+         * @param size The largest order that can be part of the tree.
+         */
+        Flat_Tree(int root, size_t size) : parents(size), child_offsets(size), child_counts(size),
+                                           root_order{root} {
+            children.reserve(size);
+        }
+
+        /**
+         * Adds a vertex to the tree as the last child of the given parent.
+         * @param parent The order of the parent, which must already be in the tree.
+         * @param child The order of the new vertex.
+         */
+        void add_child(int parent, int child) {
+            auto& count = child_counts[parent - 1];
+            auto& offset = child_offsets[parent - 1];
+            if (count == 0) {
+                offset = static_cast<int>(children.size());
+            }
+            else if (offset + count != static_cast<int>(children.size())) {
+                throw std::logic_error("The children of a vertex must be added contiguously");
+            }
+
+            children.push_back(child);
+            parents[child - 1] = parent;
+            count++;
+        }
+
+        /**
+         * @return The order of the root vertex.
+         */
+        [[nodiscard]] int root() const {
+            return root_order;
+        }
+
+        /**
+         * @return The order of the parent of the vertex, or 0 for the root.
+         */
+        [[nodiscard]] int parent(int order) const {
+            return parents[order - 1];
+        }
+
+        /**
+         * @return The orders of the children of the vertex, in the order they were added.
+         */
+        [[nodiscard]] std::span<int const> children_of(int order) const {
+            return {children.data() + child_offsets[order - 1], static_cast<size_t>(child_counts[order - 1])};
+        }
+
+        /**
+         * @return The number of vertices in the tree, including the root.
+         */
+        [[nodiscard]] size_t size() const {
+            return children.size() + 1;
+        }
+    };
+
+} // data_structures
+
+#endif //TRACE_Q_FLAT_TREE_HPP
@@ -0,0 +1,93 @@
+#ifndef TRACE_Q_ORDER_FRONTIER_HPP
+#define TRACE_Q_ORDER_FRONTIER_HPP
+
+#include <vector>
+
+namespace data_structures {
+
+    /**
+     * An ordered set of the point orders first..last, which supports removal and lookup of the next remaining
+     * order from any position.
+     * Every order keeps a skip pointer that never passes the next remaining order. Removing an order points it past
+     * itself, and lookups compress the pointers they follow, so both are amortized near-constant time and no element
+     * is ever moved.
+     */
+    class Order_Frontier {
+        int first_order{};
+        int last_order{};
+        int remaining{};
+
+        /**
+         * skip[order - first_order] is the order itself while it remains in the set, and otherwise a larger order.
+         * The extra sentinel entry at the end represents end().
+         */
+        mutable std::vector<int> skip{};
+
+    public:
+        /**
+         * Creates a set containing every order from first to last, inclusive.
+         */
+        Order_Frontier(int first, int last) : first_order{first}, last_order{last},
+                                              remaining{last >= first ? last - first + 1 : 0} {
+            skip.resize(remaining + 1);
+            for (int i = 0; i < static_cast<int>(skip.size()); ++i) {
+                skip[i] = first + i;
+            }
+        }
+
+        /**
+         * Finds the smallest remaining order that is at least the given order.
+         * @param order The order to search from.
+         * @return The found order, or end() if every order from the given one has been removed.
+         */
+        [[nodiscard]] int next(int order) const {
+            if (order < first_order) {
+                order = first_order;
+            }
+            if (order > last_order) {
+                return end();
+            }
+
+            auto root = order;
+            while (skip[root - first_order] != root) {
+                root = skip[root - first_order];
+            }
+            // Path compression, such that later lookups skip the removed orders directly
+            while (order != root) {
+                auto following = skip[order - first_order];
+                skip[order - first_order] = root;
+                order = following;
+            }
+            return root;
+        }
+
+        /**
+         * Removes an order from the set. Removing an order that is not in the set has no effect.
+         */
+        void erase(int order) {
+            if (order < first_order || order > last_order || skip[order - first_order] != order) {
+                return;
+            }
+            skip[order - first_order] = order + 1;
+            remaining--;
+        }
+
+        /**
+         * @return The sentinel order that is returned by next when no order remains.
+         */
+        [[nodiscard]] int end() const {
+            return last_order + 1;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return remaining == 0;
+        }
+
+        [[nodiscard]] int size() const {
+            return remaining;
+        }
+    };
+
+} // data_structures
+
+#endif //TRACE_Q_ORDER_FRONTIER_HPP
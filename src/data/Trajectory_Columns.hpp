@@ -0,0 +1,37 @@
+#ifndef TRACE_Q_TRAJECTORY_COLUMNS_HPP
+#define TRACE_Q_TRAJECTORY_COLUMNS_HPP
+
+#include <vector>
+#include "Trajectory.hpp"
+
+namespace data_structures {
+
+    /**
+     * A structure-of-arrays copy of a trajectory, where each attribute is stored in its own contiguous column.
+     * Timestamps are stored as seconds relative to the first location, which keeps them exact as doubles.
+     */
+    struct Trajectory_Columns {
+        std::vector<double> longitude{};
+        std::vector<double> latitude{};
+        std::vector<double> time{};
+
+        explicit Trajectory_Columns(Trajectory const& trajectory) {
+            longitude.reserve(trajectory.size());
+            latitude.reserve(trajectory.size());
+            time.reserve(trajectory.size());
+
+            for (auto const& location : trajectory.locations) {
+                longitude.push_back(location.longitude);
+                latitude.push_back(location.latitude);
+                time.push_back(static_cast<double>(location.timestamp - trajectory[0].timestamp));
+            }
+        }
+
+        [[nodiscard]] size_t size() const {
+            return time.size();
+        }
+    };
+
+}
+
+#endif //TRACE_Q_TRAJECTORY_COLUMNS_HPP
@@ -0,0 +1,227 @@
+#ifndef TRACE_Q_BASIC_CONNECTION_POOL_HPP
+#define TRACE_Q_BASIC_CONNECTION_POOL_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace database {
+
+    /**
+     * A thread-safe pool of at most a fixed number of connections, which are opened lazily and reused between
+     * checkouts. A checkout blocks, or waits up to a timeout, while every connection is leased.
+     * Connections that have been idle for longer than the health check interval are checked before they are leased
+     * again, and replaced by a new connection if the check fails. A connection whose lease ends by an exception is
+     * closed rather than reused, since it may be broken or in an unknown state.
+     * @tparam Connection The connection type.
+     */
+    template<typename Connection>
+    class Basic_Connection_Pool {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using Connect = std::function<std::unique_ptr<Connection>()>;
+        using Health_Check = std::function<bool(Connection&)>;
+
+        /**
+         * Exclusive use of a pooled connection, which is returned to the pool when the lease is destroyed.
+         */
+        class Lease {
+            Basic_Connection_Pool* pool{};
+            std::unique_ptr<Connection> connection{};
+            int uncaught_exceptions{};
+
+            friend class Basic_Connection_Pool;
+
+            Lease(Basic_Connection_Pool& pool, std::unique_ptr<Connection> connection)
+                    : pool{&pool}, connection{std::move(connection)}, uncaught_exceptions{std::uncaught_exceptions()} {}
+
+        public:
+            Lease(Lease&& other) noexcept
+                    : pool{std::exchange(other.pool, nullptr)}, connection{std::move(other.connection)},
+                      uncaught_exceptions{other.uncaught_exceptions} {}
+
+            Lease& operator=(Lease&& other) noexcept {
+                if (this != &other) {
+                    release();
+                    pool = std::exchange(other.pool, nullptr);
+                    connection = std::move(other.connection);
+                    uncaught_exceptions = other.uncaught_exceptions;
+                }
+                return *this;
+            }
+
+            Lease(Lease const&) = delete;
+            Lease& operator=(Lease const&) = delete;
+
+            ~Lease() {
+                release();
+            }
+
+            Connection& operator*() const {
+                return *connection;
+            }
+
+            Connection* operator->() const {
+                return connection.get();
+            }
+
+            /**
+             * Closes the connection instead of returning it to the pool, e.g. after it turned out to be broken.
+             */
+            void discard() {
+                if (pool != nullptr) {
+                    connection.reset();
+                    std::exchange(pool, nullptr)->close_leased();
+                }
+            }
+
+        private:
+            void release() {
+                if (pool == nullptr) {
+                    return;
+                }
+                if (std::uncaught_exceptions() > uncaught_exceptions) {
+                    discard();
+                    return;
+                }
+                std::exchange(pool, nullptr)->give_back(std::move(connection));
+            }
+        };
+
+        /**
+         * @param capacity The maximum number of open connections. Zero is replaced by one.
+         * @param connect Opens a new connection. Exceptions it throws are rethrown by the checkout.
+         * @param is_healthy Checks whether an idle connection can be reused. Without a check, idle connections are
+         * always reused.
+         * @param health_check_interval How long a connection must have been idle before it is checked again.
+         */
+        Basic_Connection_Pool(size_t capacity, Connect connect, Health_Check is_healthy = {},
+                              Clock::duration health_check_interval = std::chrono::seconds(30))
+                : capacity{capacity == 0 ? 1 : capacity}, connect{std::move(connect)},
+                  is_healthy{std::move(is_healthy)}, health_check_interval{health_check_interval} {}
+
+        Basic_Connection_Pool(Basic_Connection_Pool const&) = delete;
+        Basic_Connection_Pool& operator=(Basic_Connection_Pool const&) = delete;
+
+        /**
+         * Leases a connection, waiting for as long as every connection is leased.
+         */
+        Lease acquire() {
+            std::unique_lock lock{mutex};
+            available.wait(lock, [this]() { return can_check_out(); });
+            return check_out(lock);
+        }
+
+        /**
+         * Leases a connection, waiting at most the given timeout for one to become available.
+         * @return The lease, or nothing if every connection stayed leased for the whole timeout.
+         */
+        std::optional<Lease> try_acquire_for(Clock::duration timeout) {
+            std::unique_lock lock{mutex};
+            if (!available.wait_for(lock, timeout, [this]() { return can_check_out(); })) {
+                return std::nullopt;
+            }
+            return check_out(lock);
+        }
+
+        [[nodiscard]] size_t get_capacity() const {
+            return capacity;
+        }
+
+        /**
+         * @return The number of connections that are open, whether leased or idle.
+         */
+        [[nodiscard]] size_t open_connections() const {
+            std::scoped_lock lock{mutex};
+            return open;
+        }
+
+        /**
+         * @return The number of open connections that are not leased.
+         */
+        [[nodiscard]] size_t idle_connections() const {
+            std::scoped_lock lock{mutex};
+            return idle.size();
+        }
+
+    private:
+        struct Idle_Connection {
+            std::unique_ptr<Connection> connection{};
+            Clock::time_point idle_since{};
+        };
+
+        size_t const capacity;
+        Connect const connect;
+        Health_Check const is_healthy;
+        Clock::duration const health_check_interval;
+
+        mutable std::mutex mutex{};
+        std::condition_variable available{};
+
+        /**
+         * The idle connections, of which the most recently used is at the back.
+         */
+        std::vector<Idle_Connection> idle{};
+        size_t open{0};
+
+        [[nodiscard]] bool can_check_out() const {
+            return !idle.empty() || open < capacity;
+        }
+
+        /**
+         * Leases the most recently used idle connection, or opens a new one. The slot of the connection is reserved
+         * while the lock is held, and the connection is checked or opened after releasing it.
+         */
+        Lease check_out(std::unique_lock<std::mutex>& lock) {
+            std::optional<Idle_Connection> reused{};
+            if (!idle.empty()) {
+                reused = std::move(idle.back());
+                idle.pop_back();
+            }
+            else {
+                open++;
+            }
+            lock.unlock();
+
+            try {
+                if (reused) {
+                    if (!is_healthy || Clock::now() - reused->idle_since < health_check_interval
+                        || is_healthy(*reused->connection)) {
+                        return Lease{*this, std::move(reused->connection)};
+                    }
+                    reused->connection.reset();
+                }
+                return Lease{*this, connect()};
+            }
+            catch (...) {
+                close_leased();
+                throw;
+            }
+        }
+
+        void give_back(std::unique_ptr<Connection> connection) {
+            {
+                std::scoped_lock lock{mutex};
+                idle.push_back({std::move(connection), Clock::now()});
+            }
+            available.notify_one();
+        }
+
+        void close_leased() {
+            {
+                std::scoped_lock lock{mutex};
+                open--;
+            }
+            available.notify_one();
+        }
+    };
+
+} // database
+
+#endif //TRACE_Q_BASIC_CONNECTION_POOL_HPP
@@ -0,0 +1,60 @@
+#include <mutex>
+#include <stdexcept>
+#include "Connection_Pool.hpp"
+
+namespace database {
+
+    std::string const Connection_Pool::default_connection_string{
+            "user=postgres password=postgres host=localhost dbname=traceq port=5432"};
+
+    namespace {
+        /**
+         * The settings of the shared pool, which are read when it is created.
+         */
+        std::mutex shared_settings_mutex{};
+        std::string shared_connection_string{Connection_Pool::default_connection_string};
+        size_t shared_capacity{Connection_Pool::default_capacity};
+        bool shared_created{false};
+    }
+
+    Connection_Pool::Connection_Pool(std::string connection_string, size_t capacity,
+                                     Clock::duration health_check_interval)
+            : Basic_Connection_Pool(capacity,
+                                    [connection_string = std::move(connection_string)]() {
+                                        return std::make_unique<pqxx::connection>(connection_string);
+                                    },
+                                    &Connection_Pool::is_healthy, health_check_interval) {}
+
+    Connection_Pool& Connection_Pool::shared() {
+        static Connection_Pool pool = []() {
+            std::scoped_lock lock{shared_settings_mutex};
+            shared_created = true;
+            return Connection_Pool{shared_connection_string, shared_capacity};
+        }();
+        return pool;
+    }
+
+    void Connection_Pool::configure_shared(std::string connection_string, size_t capacity) {
+        std::scoped_lock lock{shared_settings_mutex};
+        if (shared_created) {
+            throw std::logic_error("The shared connection pool has already been created");
+        }
+        shared_connection_string = std::move(connection_string);
+        shared_capacity = capacity;
+    }
+
+    bool Connection_Pool::is_healthy(pqxx::connection& connection) {
+        if (!connection.is_open()) {
+            return false;
+        }
+        try {
+            pqxx::nontransaction txn{connection};
+            txn.exec1("SELECT 1;");
+            return true;
+        }
+        catch (pqxx::failure const&) {
+            return false;
+        }
+    }
+
+} // database
@@ -0,0 +1,54 @@
+#ifndef TRACE_Q_CONNECTION_POOL_HPP
+#define TRACE_Q_CONNECTION_POOL_HPP
+
+#include <string>
+#include <pqxx/pqxx>
+#include "Basic_Connection_Pool.hpp"
+
+namespace database {
+
+    /**
+     * The pool of PostgreSQL connections. Idle connections are checked with a round trip to the server before reuse.
+     */
+    class Connection_Pool : public Basic_Connection_Pool<pqxx::connection> {
+    public:
+        /**
+         * The connection string that specifies the connection details for the PostgreSQL database.
+         */
+        static std::string const default_connection_string;
+
+        /**
+         * The number of connections of the shared pool, which stays well below PostgreSQL's default limit of 100.
+         */
+        static constexpr size_t default_capacity{32};
+
+        /**
+         * @param connection_string The connection details of the PostgreSQL database.
+         * @param capacity The maximum number of open connections.
+         * @param health_check_interval How long a connection must have been idle before it is checked again.
+         */
+        explicit Connection_Pool(std::string connection_string = default_connection_string,
+                                 size_t capacity = default_capacity,
+                                 Clock::duration health_check_interval = std::chrono::seconds(30));
+
+        /**
+         * The pool shared by all modules that query the database.
+         */
+        static Connection_Pool& shared();
+
+        /**
+         * Sets the connection details and size of the shared pool. Must be called before its first use.
+         * @throws std::logic_error If the shared pool has already been created.
+         */
+        static void configure_shared(std::string connection_string, size_t capacity);
+
+    private:
+        /**
+         * Checks that the connection is open and that the server answers a trivial query.
+         */
+        static bool is_healthy(pqxx::connection& connection);
+    };
+
+} // database
+
+#endif //TRACE_Q_CONNECTION_POOL_HPP
@@ -39,7 +39,8 @@ int main(int argc, char* argv[]) {
     boost::asio::ip::tcp::acceptor acceptor(io_context, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), 8080));
     // Run the server
     std::cout << "The server is now running and you are ready to perform API calls." << std::endl;
-    api::run(acceptor, endpoints);
+    api::run(io_context, acceptor, endpoints);
+    std::cout << "The server has stopped." << std::endl;
 
     return 0;
 }
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <tuple>
+#include <pqxx/pqxx>
+#include "KNN_Index.hpp"
+#include "../database/Connection_Pool.hpp"
+
+namespace spatial_queries {
+
+    namespace {
+        double euclidean_distance(data_structures::Location const& location, KNN_Query::KNN_Origin const& origin) {
+            auto dx = location.longitude - origin.x;
+            auto dy = location.latitude - origin.y;
+            return std::sqrt(dx * dx + dy * dy);
+        }
+    }
+
+    double KNN_Index::Bounds::distance(KNN_Query::KNN_Origin const& origin) const {
+        auto dx = std::max({x_low - origin.x, 0.0, origin.x - x_high});
+        auto dy = std::max({y_low - origin.y, 0.0, origin.y - y_high});
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    KNN_Index::KNN_Index(std::vector<data_structures::Trajectory> const& trajectories) {
+        auto extend = [](Bounds& bounds, Location const& location) {
+            bounds.x_low = std::min(bounds.x_low, location.longitude);
+            bounds.x_high = std::max(bounds.x_high, location.longitude);
+            bounds.y_low = std::min(bounds.y_low, location.latitude);
+            bounds.y_high = std::max(bounds.y_high, location.latitude);
+            bounds.t_low = std::min(bounds.t_low, location.timestamp);
+            bounds.t_high = std::max(bounds.t_high, location.timestamp);
+        };
+        auto const empty = Bounds{std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                                  std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                                  std::numeric_limits<unsigned long>::max(), std::numeric_limits<unsigned long>::min()};
+
+        size_t location_count = 0;
+        for (auto const& trajectory : trajectories) {
+            location_count += trajectory.size();
+        }
+        locations.reserve(location_count);
+        blocks.reserve(location_count / block_size + trajectories.size());
+        this->trajectories.reserve(trajectories.size());
+
+        for (auto const& trajectory : trajectories) {
+            if (trajectory.locations.empty()) {
+                continue;
+            }
+            Indexed_Trajectory indexed{trajectory.id, empty, blocks.size(), blocks.size()};
+            auto first_location = locations.size();
+            locations.insert(locations.end(), trajectory.locations.begin(), trajectory.locations.end());
+            std::ranges::stable_sort(locations.begin() + static_cast<std::ptrdiff_t>(first_location), locations.end(),
+                                     {}, &Location::timestamp);
+
+            for (auto begin = first_location; begin < locations.size(); begin += block_size) {
+                Block block{empty, begin, std::min(begin + block_size, locations.size())};
+                for (auto i = block.begin; i < block.end; ++i) {
+                    extend(block.bounds, locations[i]);
+                    extend(indexed.bounds, locations[i]);
+                }
+                blocks.push_back(block);
+            }
+            indexed.last_block = blocks.size();
+            this->trajectories.push_back(indexed);
+        }
+    }
+
+    KNN_Index KNN_Index::load(std::string const& table) {
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
+        auto rows = txn.query<unsigned int, double, double, unsigned long>(
+                "SELECT trajectory_id, coordinates[0], coordinates[1], time FROM " + table + " ORDER BY trajectory_id;");
+        txn.commit();
+
+        std::vector<data_structures::Trajectory> trajectories{};
+        for (auto const& [id, x, y, time] : rows) {
+            if (trajectories.empty() || trajectories.back().id != id) {
+                trajectories.push_back(data_structures::Trajectory{id, {}});
+            }
+            auto& locations = trajectories.back().locations;
+            locations.push_back(Location{static_cast<int>(locations.size()) + 1, time, x, y});
+        }
+        return KNN_Index{trajectories};
+    }
+
+    double KNN_Index::nearest_distance(Indexed_Trajectory const& trajectory, KNN_Query::KNN_Origin const& origin,
+                                       double cutoff) const {
+        auto nearest = cutoff;
+        bool found = false;
+        for (auto b = trajectory.first_block; b < trajectory.last_block; ++b) {
+            auto const& block = blocks[b];
+            if (!block.bounds.overlaps(origin) || block.bounds.distance(origin) >= nearest) {
+                continue;
+            }
+            for (auto i = block.begin; i < block.end; ++i) {
+                auto const& location = locations[i];
+                if (location.timestamp < origin.t_low || location.timestamp > origin.t_high) {
+                    continue;
+                }
+                auto distance = euclidean_distance(location, origin);
+                if (distance < nearest) {
+                    nearest = distance;
+                    found = true;
+                }
+            }
+        }
+        return found ? nearest : std::numeric_limits<double>::infinity();
+    }
+
+    std::vector<KNN_Query::KNN_Result_Element> KNN_Index::get_ids_from_knn(
+            int k, KNN_Query::KNN_Origin const& query_origin) const {
+        std::vector<KNN_Query::KNN_Result_Element> result{};
+        if (k <= 0) {
+            return result;
+        }
+
+        // A heap of the trajectories by the distance to their bounding box, which is only ordered as far as it is visited
+        std::vector<std::pair<double, size_t>> candidates{};
+        for (size_t i = 0; i < trajectories.size(); ++i) {
+            if (trajectories[i].bounds.overlaps(query_origin)) {
+                candidates.emplace_back(trajectories[i].bounds.distance(query_origin), i);
+            }
+        }
+        std::ranges::make_heap(candidates, std::greater{});
+
+        // The nearest trajectories found so far, with the farthest on top
+        auto farther = [](KNN_Query::KNN_Result_Element const& a, KNN_Query::KNN_Result_Element const& b) {
+            return std::tie(a.distance, a.id) < std::tie(b.distance, b.id);
+        };
+        std::priority_queue<KNN_Query::KNN_Result_Element, std::vector<KNN_Query::KNN_Result_Element>,
+                            decltype(farther)> nearest{farther};
+        auto const size = static_cast<size_t>(k);
+
+        while (!candidates.empty()) {
+            std::ranges::pop_heap(candidates, std::greater{});
+            auto [lower_bound, index] = candidates.back();
+            candidates.pop_back();
+
+            auto cutoff = std::numeric_limits<double>::infinity();
+            if (nearest.size() == size) {
+                cutoff = nearest.top().distance;
+                if (lower_bound > cutoff) {
+                    break;
+                }
+                // A trajectory at the same distance as the k-th may still precede it by ID
+                cutoff = std::nextafter(cutoff, std::numeric_limits<double>::infinity());
+            }
+
+            auto const& trajectory = trajectories[index];
+            auto distance = nearest_distance(trajectory, query_origin, cutoff);
+            if (std::isinf(distance)) {
+                continue;
+            }
+            KNN_Query::KNN_Result_Element element{trajectory.id, distance};
+            if (nearest.size() < size) {
+                nearest.push(element);
+            }
+            else if (farther(element, nearest.top())) {
+                nearest.pop();
+                nearest.push(element);
+            }
+        }
+
+        result.resize(nearest.size());
+        for (auto i = result.size(); i > 0; --i) {
+            result[i - 1] = nearest.top();
+            nearest.pop();
+        }
+        return result;
+    }
+
+} // spatial_queries
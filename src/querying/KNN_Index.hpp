@@ -0,0 +1,114 @@
+#ifndef TRACE_Q_KNN_INDEX_HPP
+#define TRACE_Q_KNN_INDEX_HPP
+
+#include <string>
+#include <vector>
+#include "../data/Trajectory.hpp"
+#include "KNN_Query.hpp"
+
+namespace spatial_queries {
+
+    /**
+     * An in-memory index of a set of trajectories that answers the same K-Nearest-Neighbour queries as
+     * KNN_Query::get_ids_from_knn without a database round trip.
+     * The locations of every trajectory are kept in time order and grouped into blocks of consecutive locations, each
+     * with a bounding box and a time interval. A query visits the trajectories in order of the distance from the origin
+     * to their bounding box, and stops once that lower bound exceeds the k-th nearest distance found so far. Within a
+     * trajectory, blocks outside the time interval of the query or farther away than its nearest location so far are
+     * skipped.
+     */
+    class KNN_Index {
+        using Location = data_structures::Location;
+
+        struct Bounds {
+            double x_low{};
+            double x_high{};
+            double y_low{};
+            double y_high{};
+            unsigned long t_low{};
+            unsigned long t_high{};
+
+            /**
+             * Whether the time interval intersects the time interval of the query origin.
+             */
+            [[nodiscard]] bool overlaps(KNN_Query::KNN_Origin const& origin) const {
+                return t_low <= origin.t_high && t_high >= origin.t_low;
+            }
+
+            /**
+             * A lower bound on the distance from the origin to any location within the bounds.
+             */
+            [[nodiscard]] double distance(KNN_Query::KNN_Origin const& origin) const;
+        };
+
+        /**
+         * The locations [begin, end) of a trajectory and their bounds.
+         */
+        struct Block {
+            Bounds bounds{};
+            size_t begin{};
+            size_t end{};
+        };
+
+        /**
+         * A trajectory, whose blocks are [first_block, last_block).
+         */
+        struct Indexed_Trajectory {
+            unsigned int id{};
+            Bounds bounds{};
+            size_t first_block{};
+            size_t last_block{};
+        };
+
+        /**
+         * The number of consecutive locations per block.
+         */
+        static constexpr size_t block_size{32};
+
+        std::vector<Location> locations{};
+        std::vector<Block> blocks{};
+        std::vector<Indexed_Trajectory> trajectories{};
+
+        /**
+         * The distance from the origin to the trajectory's nearest location within the time interval of the origin,
+         * if it is less than the cutoff.
+         * @return The distance, or infinity if no location within the time interval is closer than the cutoff.
+         */
+        [[nodiscard]] double nearest_distance(Indexed_Trajectory const& trajectory, KNN_Query::KNN_Origin const& origin,
+                                              double cutoff) const;
+
+    public:
+        /**
+         * Indexes the given trajectories. The locations of a trajectory need not be in time order.
+         * @param trajectories The trajectories to index, with distinct IDs.
+         */
+        explicit KNN_Index(std::vector<data_structures::Trajectory> const& trajectories);
+
+        /**
+         * Loads all trajectories of the given table from the database into an index.
+         * @param table The table to load.
+         */
+        static KNN_Index load(std::string const& table);
+
+        /**
+         * Performs a K-Nearest-Neighbour query like KNN_Query::get_ids_from_knn. The distance of a trajectory is the
+         * distance from the origin to its nearest location within the time interval of the origin, and trajectories
+         * without locations within the time interval are not part of the result.
+         * @param k The amount of nearest neighbours to return.
+         * @param query_origin The origin point from where the nearest neighbours are discovered using euclidean distance.
+         * @return The K-Nearest-Neighbours in increasing order of distance. Equal distances are ordered by ID.
+         */
+        [[nodiscard]] std::vector<KNN_Query::KNN_Result_Element> get_ids_from_knn(
+                int k, KNN_Query::KNN_Origin const& query_origin) const;
+
+        /**
+         * @return The number of indexed trajectories.
+         */
+        [[nodiscard]] size_t size() const {
+            return trajectories.size();
+        }
+    };
+
+} // spatial_queries
+
+#endif //TRACE_Q_KNN_INDEX_HPP
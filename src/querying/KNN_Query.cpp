@@ -1,17 +1,23 @@
 #include <pqxx/pqxx>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <iomanip>
 #include <limits>
 #include "KNN_Query.hpp"
+#include "../database/Connection_Pool.hpp"
 
 namespace spatial_queries {
 
-    std::string KNN_Query::connection_string {"user=postgres password=postgres host=localhost dbname=traceq port=5432"};
-
     std::vector<KNN_Query::KNN_Result_Element> KNN_Query::get_ids_from_knn(
             std::string const& table, int k, KNN_Origin const& query_origin) {
-        pqxx::connection c{connection_string};
-        pqxx::work txn{c};
+        auto connection = database::Connection_Pool::shared().acquire();
+        return get_ids_from_knn(*connection, table, k, query_origin);
+    }
+
+    std::vector<KNN_Query::KNN_Result_Element> KNN_Query::get_ids_from_knn(
+            pqxx::connection& connection, std::string const& table, int k, KNN_Origin const& query_origin) {
+        pqxx::work txn{connection};
         std::stringstream query{};
 
         query << "SELECT trajectory_id, MIN(coordinates <-> POINT("
@@ -41,4 +47,43 @@ namespace spatial_queries {
         return result;
     }
 
-} // spatial_queries
\ No newline at end of file
+    std::vector<std::vector<KNN_Query::KNN_Result_Element>> KNN_Query::get_ids_from_knn_batch(
+            std::string const& table, int k, std::vector<KNN_Origin> const& query_origins) {
+        std::vector<std::vector<KNN_Result_Element>> result(query_origins.size());
+        if (query_origins.empty()) {
+            return result;
+        }
+
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
+        auto query_result = txn.query<int, int, double>(create_knn_batch_query(table, k, query_origins));
+        txn.commit();
+
+        for (auto& [origin_id, id, dist] : query_result) {
+            result[origin_id].emplace_back(id, dist);
+        }
+        return result;
+    }
+
+    std::string KNN_Query::create_knn_batch_query(std::string const& table, int k,
+                                                  std::vector<KNN_Origin> const& query_origins) {
+        // The time column is a BIGINT, so unbounded time intervals are clamped to its range
+        auto const max_time = static_cast<unsigned long>(std::numeric_limits<long>::max());
+
+        std::stringstream query{};
+        query << std::setprecision(std::numeric_limits<double>::max_digits10);
+        query << "SELECT o.origin_id, knn.trajectory_id, knn.dist FROM (VALUES ";
+        for (size_t i = 0; i < query_origins.size(); ++i) {
+            auto const& origin = query_origins[i];
+            query << (i == 0 ? "" : ", ") << "(" << i << ", " << origin.x << "::float8, " << origin.y << "::float8, "
+                  << std::min(origin.t_low, max_time) << "::bigint, " << std::min(origin.t_high, max_time) << "::bigint)";
+        }
+        query << ") AS o(origin_id, x, y, t_low, t_high) CROSS JOIN LATERAL ("
+              << "SELECT trajectory_id, MIN(coordinates <-> POINT(o.x, o.y)) AS dist FROM " << table
+              << " WHERE time >= o.t_low AND time <= o.t_high"
+              << " GROUP BY trajectory_id ORDER BY MIN(coordinates <-> POINT(o.x, o.y)) LIMIT " << k
+              << ") AS knn ORDER BY o.origin_id, knn.dist;";
+        return query.str();
+    }
+
+} // spatial_queries
@@ -2,6 +2,7 @@
 #define TRACE_Q_KNN_QUERY_HPP
 
 #include <pqxx/pqxx>
+#include <limits>
 #include <vector>
 #include <string>
 
@@ -36,11 +37,29 @@ namespace spatial_queries {
          */
         static std::vector<KNN_Result_Element> get_ids_from_knn(std::string const& table, int k, KNN_Origin const& query_origin);
 
-    private:
         /**
-         * The connection string that specifies the connection details for the PostgreSQL database.
+         * Performs a K-Nearest-Neighbour query like get_ids_from_knn, on the given connection instead of a pooled one.
+         * @param connection The connection to perform the query on.
          */
-        static std::string connection_string;
+        static std::vector<KNN_Result_Element> get_ids_from_knn(pqxx::connection& connection, std::string const& table,
+                                                                int k, KNN_Origin const& query_origin);
+
+        /**
+         * Performs a K-Nearest-Neighbour query for every origin in a single statement, which joins a VALUES list of
+         * the origins laterally to the KNN query of get_ids_from_knn.
+         * @param table The table to query.
+         * @param k The amount of nearest neighbours to return per origin.
+         * @param query_origins The origin points of the queries.
+         * @return For every origin, in the same order, the list of KNN Results like get_ids_from_knn returns it.
+         */
+        static std::vector<std::vector<KNN_Result_Element>> get_ids_from_knn_batch(
+                std::string const& table, int k, std::vector<KNN_Origin> const& query_origins);
+
+        /**
+         * Creates the statement of get_ids_from_knn_batch.
+         */
+        static std::string create_knn_batch_query(std::string const& table, int k,
+                                                  std::vector<KNN_Origin> const& query_origins);
     };
 
 } // spatial_queries
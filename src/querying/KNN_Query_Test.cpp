@@ -1,9 +1,23 @@
 #include <cmath>
+#include <limits>
 #include "KNN_Query_Test.hpp"
 
 namespace spatial_queries {
     std::string KNN_Query_Test::table_name{"original_trajectories"};
 
+    std::vector<std::shared_ptr<KNN_Query_Test>> KNN_Query_Test::create_batch(
+            unsigned int original_trajectory_id, int k, std::vector<KNN_Query::KNN_Origin> const& query_origins) {
+        auto query_results = KNN_Query::get_ids_from_knn_batch(table_name, k + 1, query_origins);
+
+        std::vector<std::shared_ptr<KNN_Query_Test>> result{};
+        result.reserve(query_origins.size());
+        for (size_t i = 0; i < query_origins.size(); ++i) {
+            result.push_back(std::make_shared<KNN_Query_Test>(original_trajectory_id, k, query_origins[i],
+                                                              std::move(query_results[i])));
+        }
+        return result;
+    }
+
     bool KNN_Query_Test::operator()(data_structures::Trajectory const& trajectory) {
 
         auto min_distance_simplified = std::numeric_limits<double>::max();
@@ -31,6 +45,19 @@ namespace spatial_queries {
         return false;
     }
 
+    bool KNN_Query_Test::is_satisfied_by(data_structures::Location const& location) const {
+        if (location.timestamp < origin.t_low || location.timestamp > origin.t_high) {
+            return false;
+        }
+
+        auto location_distance = euclidean_distance(location, origin);
+        if (!(location_distance < std::numeric_limits<double>::max())) {
+            return false;
+        }
+
+        return query_result.size() <= static_cast<size_t>(k) || location_distance <= query_result.back().distance;
+    }
+
     double KNN_Query_Test::euclidean_distance(data_structures::Location const& location, KNN_Query::KNN_Origin const& origin) {
         return std::sqrt(std::pow(location.longitude - origin.x, 2) + std::pow(location.latitude - origin.y, 2));
     }
@@ -1,6 +1,7 @@
 #ifndef TRACE_Q_KNN_QUERY_TEST_HPP
 #define TRACE_Q_KNN_QUERY_TEST_HPP
 
+#include <memory>
 #include "Query.hpp"
 #include "KNN_Query.hpp"
 
@@ -38,18 +39,53 @@ namespace spatial_queries {
          */
         bool original_in_result{false};
 
+        /**
+         * Performs the K-Nearest-Neighbour query on the original trajectories in the database.
+         */
         KNN_Query_Test(unsigned int original_trajectory_id, int k, KNN_Query::KNN_Origin const& query_origin)
-        : origin{query_origin}, k{k} {
-            query_result = KNN_Query::get_ids_from_knn(table_name, k + 1, query_origin);
-            for (int i = 0; i < k && i < query_result.size(); i++) {
-                if (original_trajectory_id == query_result[i].id) {
+        : KNN_Query_Test(original_trajectory_id, k, query_origin,
+                         KNN_Query::get_ids_from_knn(table_name, k + 1, query_origin)) {}
+
+        /**
+         * Uses a result of the K-Nearest-Neighbour query on the original trajectories that is already known, e.g.
+         * from a KNN_Index.
+         * @param query_result The k + 1 nearest original trajectories, in increasing order of distance.
+         */
+        KNN_Query_Test(unsigned int original_trajectory_id, int k, KNN_Query::KNN_Origin const& query_origin,
+                       std::vector<KNN_Query::KNN_Result_Element> query_result)
+        : origin{query_origin}, k{k}, query_result{std::move(query_result)} {
+            for (int i = 0; i < k && i < this->query_result.size(); i++) {
+                if (original_trajectory_id == this->query_result[i].id) {
                     original_in_result = true;
                 }
             }
         }
 
+        /**
+         * Creates a KNN query test for every origin, performing all of their K-Nearest-Neighbour queries on the original
+         * trajectories in the database as a single statement.
+         * @param original_trajectory_id The ID of the original trajectory.
+         * @param k The amount of nearest neighbours.
+         * @param query_origins The origin points of the queries.
+         * @return The KNN query tests, in the same order as the origins.
+         */
+        static std::vector<std::shared_ptr<KNN_Query_Test>> create_batch(
+                unsigned int original_trajectory_id, int k, std::vector<KNN_Query::KNN_Origin> const& query_origins);
+
         bool operator()(data_structures::Trajectory const& trajectory) override;
 
+        /**
+         * Determines whether the location on its own passes the query, i.e. whether it is within the time interval of
+         * the origin and no farther from the origin than the k+1-th nearest original trajectory.
+         * A simplified trajectory passes the query exactly if one of its locations does.
+         * @param location A location of the simplified trajectory.
+         */
+        [[nodiscard]] bool is_satisfied_by(data_structures::Location const& location) const;
+
+        [[nodiscard]] KNN_Query::KNN_Origin const& get_origin() const {
+            return origin;
+        }
+
         ~KNN_Query_Test() override = default;
     };
 
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <tuple>
+#include "Query_Evaluator.hpp"
+#include "Range_Query_Test.hpp"
+#include "../concurrency/Work_Stealing_Pool.hpp"
+
+namespace spatial_queries {
+
+    Query_Evaluator::Query_Evaluator(std::vector<std::shared_ptr<Query>> const& query_objects, bool use_knn)
+            : query_objects{query_objects}, use_knn{use_knn} {
+        for (auto const& query_object : query_objects) {
+            if (auto* range_query = dynamic_cast<Range_Query_Test*>(query_object.get())) {
+                windows.push_back(range_query->get_window());
+                original_in_windows.push_back(range_query->original_in_window);
+            }
+            else if (auto* knn_query = dynamic_cast<KNN_Query_Test*>(query_object.get()); knn_query && use_knn) {
+                knn_tests.push_back(knn_query);
+            }
+        }
+        range_failures.resize(windows.size());
+        knn_failures.resize(knn_tests.size());
+
+        // Small windows and short time intervals are the most likely to be missed by a coarse simplification
+        range_order.resize(windows.size());
+        std::iota(range_order.begin(), range_order.end(), 0);
+        std::ranges::stable_sort(range_order, {}, [this](size_t i) {
+            auto const& window = windows[i];
+            return std::make_tuple((window.x_high - window.x_low) * (window.y_high - window.y_low),
+                                   window.t_high - window.t_low);
+        });
+        knn_order.resize(knn_tests.size());
+        std::iota(knn_order.begin(), knn_order.end(), 0);
+        std::ranges::stable_sort(knn_order, {}, [this](size_t i) {
+            return knn_tests[i]->get_origin().t_high - knn_tests[i]->get_origin().t_low;
+        });
+    }
+
+    Query_Evaluator::Query_Evaluator(data_structures::Trajectory const& original_trajectory,
+                                     std::vector<std::shared_ptr<Query>> const& query_objects, bool use_knn)
+            : Query_Evaluator(query_objects, use_knn) {
+        original_locations = original_trajectory.locations;
+        original_by_key.resize(original_locations.size());
+        std::iota(original_by_key.begin(), original_by_key.end(), 0);
+        std::ranges::stable_sort(original_by_key, {}, [this](size_t i) { return key_of(original_locations[i]); });
+        index_original_locations();
+
+        in_candidate.resize(original_locations.size());
+        in_next_candidate.resize(original_locations.size());
+        window_locations.resize(windows.size(), Range_Query::no_location);
+        passing_locations.resize(knn_tests.size());
+        // No location passes any test of the empty candidate, so only the windows without the original are correct
+        correct_range_queries = static_cast<int>(std::ranges::count(original_in_windows, false));
+        incremental = true;
+    }
+
+    double Query_Evaluator::f1(int correct, int total) {
+        return static_cast<double>(correct) / (correct + 0.5 * (static_cast<double>(total - correct)));
+    }
+
+    Query_Evaluator::F1_Bounds Query_Evaluator::f1_bounds(int correct, int incorrect, int total) {
+        // The F1-score increases with the number of passed tests, so the bounds are where every remaining test fails
+        // or passes
+        return F1_Bounds{f1(correct, total), f1(total - incorrect, total)};
+    }
+
+    Query_Evaluator::Accuracy Query_Evaluator::accuracy(data_structures::Trajectory const& trajectory) {
+        if (incremental && update_candidate(trajectory)) {
+            return current_accuracy();
+        }
+
+        auto range_queries = static_cast<int>(windows.size());
+        auto range_f1 = f1(evaluate_range(trajectory, 0, windows.size()), range_queries);
+        if (!use_knn) {
+            return Accuracy{range_f1, 0};
+        }
+        auto knn_queries = static_cast<int>(knn_tests.size());
+        return Accuracy{range_f1, f1(evaluate_knn(trajectory, 0, knn_tests.size()), knn_queries)};
+    }
+
+    bool Query_Evaluator::accepts(data_structures::Trajectory const& trajectory, double min_range_f1,
+                                  double min_knn_f1) {
+        if (incremental && update_candidate(trajectory)) {
+            auto [range_f1, knn_f1] = current_accuracy();
+            return range_f1 >= min_range_f1 && knn_f1 >= min_knn_f1;
+        }
+
+        // Without KNN queries, their F1-score is 0. The range tests are evaluated first, since a whole chunk of them
+        // costs a single pass over the trajectory.
+        auto accepted = (use_knn || 0.0 >= min_knn_f1)
+                && decide(windows.size(), min_range_f1, [&](size_t begin, size_t end) {
+                    return evaluate_range(trajectory, begin, end);
+                })
+                && (!use_knn || decide(knn_tests.size(), min_knn_f1, [&](size_t begin, size_t end) {
+                    return evaluate_knn(trajectory, begin, end);
+                }));
+
+        reorder(range_order, range_failures);
+        reorder(knn_order, knn_failures);
+        return accepted;
+    }
+
+    template<typename Evaluate>
+    bool Query_Evaluator::decide(size_t total, double min_f1, Evaluate evaluate) {
+        auto const tests = static_cast<int>(total);
+        int correct = 0;
+        int incorrect = 0;
+        size_t next = 0;
+        for (auto chunk_size = initial_chunk_size;; chunk_size *= 2) {
+            // Once every test is evaluated, both bounds are the F1-score and one of these holds
+            auto [lower, upper] = f1_bounds(correct, incorrect, tests);
+            if (!(upper >= min_f1)) {
+                return false;
+            }
+            if (lower >= min_f1) {
+                return true;
+            }
+
+            auto end = std::min(total, next + chunk_size);
+            auto passed = evaluate(next, end);
+            correct += passed;
+            incorrect += static_cast<int>(end - next) - passed;
+            next = end;
+        }
+    }
+
+    int Query_Evaluator::evaluate_range(data_structures::Trajectory const& trajectory, size_t begin, size_t end) {
+        std::vector<Range_Query::Window> chunk{};
+        chunk.reserve(end - begin);
+        for (auto i = begin; i < end; ++i) {
+            chunk.push_back(windows[range_order[i]]);
+        }
+
+        // All windows of the chunk are evaluated in one pass over the trajectory rather than one scan per window
+        auto in_windows = Range_Query::in_range_batch(trajectory, chunk);
+        int correct = 0;
+        for (auto i = begin; i < end; ++i) {
+            auto test = range_order[i];
+            if (in_windows[i - begin] == original_in_windows[test]) {
+                correct++;
+            }
+            else {
+                range_failures[test]++;
+            }
+        }
+        evaluated += static_cast<long>(end - begin);
+        return correct;
+    }
+
+    int Query_Evaluator::evaluate_knn(data_structures::Trajectory const& trajectory, size_t begin, size_t end) {
+        std::vector<char> passed(end - begin);
+
+        // A single query test is far too cheap for a task of its own, so the tests are evaluated in chunks
+        concurrency::Work_Stealing_Pool::shared().parallel_for(begin, end, [&](size_t chunk_begin, size_t chunk_end) {
+            for (auto i = chunk_begin; i < chunk_end; ++i) {
+                passed[i - begin] = (*knn_tests[knn_order[i]])(trajectory);
+            }
+        });
+
+        int correct = 0;
+        for (auto i = begin; i < end; ++i) {
+            if (passed[i - begin]) {
+                correct++;
+            }
+            else {
+                knn_failures[knn_order[i]]++;
+            }
+        }
+        evaluated += static_cast<long>(end - begin);
+        return correct;
+    }
+
+    Query_Evaluator::Accuracy Query_Evaluator::current_accuracy() const {
+        auto range_f1 = f1(correct_range_queries, static_cast<int>(windows.size()));
+        if (!use_knn) {
+            return Accuracy{range_f1, 0};
+        }
+        return Accuracy{range_f1, f1(correct_knn_queries, static_cast<int>(knn_tests.size()))};
+    }
+
+    void Query_Evaluator::index_original_locations() {
+        std::vector<size_t> by_time(original_locations.size());
+        std::iota(by_time.begin(), by_time.end(), 0);
+        std::ranges::stable_sort(by_time, {}, [this](size_t i) { return original_locations[i].timestamp; });
+
+        // Only the locations within the time interval of a test can pass it
+        std::vector<std::vector<unsigned int>> passing(knn_tests.size());
+        concurrency::Work_Stealing_Pool::shared().parallel_for(0, knn_tests.size(), [&](size_t begin, size_t end) {
+            for (auto test = begin; test < end; ++test) {
+                auto const& knn_test = *knn_tests[test];
+                auto first = std::ranges::lower_bound(by_time, knn_test.get_origin().t_low, {}, [this](size_t i) {
+                    return original_locations[i].timestamp;
+                });
+                for (auto it = first; it != by_time.end()
+                                      && original_locations[*it].timestamp <= knn_test.get_origin().t_high; ++it) {
+                    if (knn_test.is_satisfied_by(original_locations[*it])) {
+                        passing[test].push_back(static_cast<unsigned int>(*it));
+                    }
+                }
+            }
+        });
+
+        passed_offsets.assign(original_locations.size() + 1, 0);
+        for (auto const& locations : passing) {
+            for (auto location : locations) {
+                passed_offsets[location + 1]++;
+            }
+        }
+        std::partial_sum(passed_offsets.begin(), passed_offsets.end(), passed_offsets.begin());
+        passed_tests.resize(passed_offsets.back());
+        auto next = passed_offsets;
+        for (size_t test = 0; test < passing.size(); ++test) {
+            for (auto location : passing[test]) {
+                passed_tests[next[location]++] = static_cast<unsigned int>(test);
+            }
+        }
+    }
+
+    Query_Evaluator::Location_Key Query_Evaluator::key_of(data_structures::Location const& location) {
+        return {location.timestamp, location.longitude, location.latitude};
+    }
+
+    size_t Query_Evaluator::find_original(data_structures::Location const& location) const {
+        auto key = key_of(location);
+        auto it = std::ranges::lower_bound(original_by_key, key, {}, [this](size_t i) {
+            return key_of(original_locations[i]);
+        });
+        if (it == original_by_key.end() || key_of(original_locations[*it]) != key) {
+            return Range_Query::no_location;
+        }
+        return *it;
+    }
+
+    bool Query_Evaluator::update_candidate(data_structures::Trajectory const& trajectory) {
+        std::vector<size_t> next{};
+        next.reserve(trajectory.size());
+        for (auto const& location : trajectory.locations) {
+            auto original = find_original(location);
+            if (original == Range_Query::no_location) {
+                return false;
+            }
+            next.push_back(original);
+        }
+
+        for (auto i : next) {
+            in_next_candidate[i] = true;
+        }
+        for (auto i : candidate_locations) {
+            if (!in_next_candidate[i]) {
+                in_candidate[i] = false;
+                update_location(i, -1);
+            }
+        }
+
+        data_structures::Trajectory added{trajectory.id, {}};
+        std::vector<size_t> added_locations{};
+        candidate_locations.clear();
+        for (auto i : next) {
+            if (!in_next_candidate[i]) {
+                continue; // A duplicate
+            }
+            in_next_candidate[i] = false;
+            candidate_locations.push_back(i);
+            if (!in_candidate[i]) {
+                in_candidate[i] = true;
+                update_location(i, 1);
+                added.locations.push_back(original_locations[i]);
+                added_locations.push_back(i);
+            }
+        }
+
+        // A window whose location was removed may contain another location of the candidate, while a window without
+        // a location can only contain one of the added locations
+        std::vector<size_t> lost{};
+        std::vector<size_t> empty{};
+        for (size_t test = 0; test < windows.size(); ++test) {
+            if (window_locations[test] == Range_Query::no_location) {
+                empty.push_back(test);
+            }
+            else if (!in_candidate[window_locations[test]]) {
+                lost.push_back(test);
+            }
+        }
+        update_windows(trajectory, next, lost);
+        update_windows(added, added_locations, empty);
+        return true;
+    }
+
+    void Query_Evaluator::update_location(size_t location, int change) {
+        updated += static_cast<long>(passed_offsets[location + 1] - passed_offsets[location]);
+        for (auto offset = passed_offsets[location]; offset < passed_offsets[location + 1]; ++offset) {
+            auto test = passed_tests[offset];
+            auto was_satisfied = passing_locations[test] > 0;
+            passing_locations[test] += change;
+            if (was_satisfied != (passing_locations[test] > 0)) {
+                correct_knn_queries += was_satisfied ? -1 : 1;
+            }
+        }
+    }
+
+    void Query_Evaluator::update_windows(data_structures::Trajectory const& trajectory,
+                                         std::vector<size_t> const& original_indices_of_trajectory,
+                                         std::vector<size_t> const& tests) {
+        if (tests.empty()) {
+            return;
+        }
+        updated += static_cast<long>(tests.size());
+        std::vector<Range_Query::Window> searched{};
+        searched.reserve(tests.size());
+        for (auto test : tests) {
+            searched.push_back(windows[test]);
+        }
+
+        auto found = Range_Query::find_in_range_batch(trajectory, searched);
+        for (size_t i = 0; i < tests.size(); ++i) {
+            auto test = tests[i];
+            auto was_satisfied = window_locations[test] != Range_Query::no_location;
+            window_locations[test] = found[i] == Range_Query::no_location ? Range_Query::no_location
+                                                                          : original_indices_of_trajectory[found[i]];
+            if (was_satisfied != (found[i] != Range_Query::no_location)) {
+                correct_range_queries += was_satisfied == original_in_windows[test] ? -1 : 1;
+            }
+        }
+    }
+
+    void Query_Evaluator::reorder(std::vector<size_t>& order, std::vector<int> const& failures) {
+        std::ranges::stable_sort(order, std::greater{}, [&failures](size_t i) { return failures[i]; });
+    }
+
+} // spatial_queries
@@ -0,0 +1,260 @@
+#ifndef TRACE_Q_QUERY_EVALUATOR_HPP
+#define TRACE_Q_QUERY_EVALUATOR_HPP
+
+#include <memory>
+#include <tuple>
+#include <vector>
+#include "Query.hpp"
+#include "Range_Query.hpp"
+#include "KNN_Query_Test.hpp"
+
+namespace spatial_queries {
+
+    /**
+     * Evaluates the query tests of an original trajectory against its candidate simplifications.
+     * Whether a candidate upholds the minimum F1-scores is decided with early exit: the tests are evaluated in chunks,
+     * and after every chunk the final F1-score of each kind of query is bounded by assuming that the remaining tests
+     * all pass or all fail. Evaluation stops as soon as these bounds decide the candidate.
+     * The tests that failed most often on earlier candidates are evaluated first, since they are the most likely to
+     * fail again. Before any candidate has been evaluated, the narrowest queries go first.
+     *
+     * Given the original trajectory, the evaluator instead keeps the state of every test for the current candidate,
+     * and moving to another candidate made of original locations, such as the next MRPA level, only re-checks the
+     * tests touched by the locations that were removed or added. A range test keeps one location of the candidate in
+     * its window, and is only searched again if that location is removed, or if it has none, among the added
+     * locations. A KNN test keeps the number of locations of the candidate that pass it on their own, which is updated
+     * from the tests passed by every changed location. This costs about the number of changed locations rather than
+     * the number of tests times the number of locations. Candidates with other locations are evaluated in chunks.
+     * An evaluator is used by a single thread at a time.
+     */
+    class Query_Evaluator {
+    public:
+        /**
+         * The F1-scores of range and KNN queries performed on a simplified trajectory.
+         */
+        struct Accuracy {
+            double range_f1{};
+            double knn_f1{};
+        };
+
+        /**
+         * Bounds on an F1-score of which only part of the tests have been evaluated.
+         */
+        struct F1_Bounds {
+            double lower{};
+            double upper{};
+        };
+
+        /**
+         * @param query_objects The query tests, which are range and KNN query tests.
+         * @param use_knn Whether the KNN queries decide the accuracy. Otherwise, the KNN F1-score is 0.
+         */
+        Query_Evaluator(std::vector<std::shared_ptr<Query>> const& query_objects, bool use_knn);
+
+        /**
+         * Evaluates candidates made of locations of the original trajectory incrementally. The locations of a
+         * candidate are matched to those of the original by their timestamp and coordinates, since simplifications
+         * such as MRPA renumber their orders.
+         * @param original_trajectory The original trajectory.
+         * @param query_objects The query tests of the original trajectory, which are range and KNN query tests.
+         * @param use_knn Whether the KNN queries decide the accuracy. Otherwise, the KNN F1-score is 0.
+         */
+        Query_Evaluator(data_structures::Trajectory const& original_trajectory,
+                        std::vector<std::shared_ptr<Query>> const& query_objects, bool use_knn);
+
+        /**
+         * The F1-score of a kind of query, where a failed test is counted as half a false positive and half a false
+         * negative.
+         * @param correct The number of tests that passed.
+         * @param total The number of tests.
+         */
+        static double f1(int correct, int total);
+
+        /**
+         * Bounds the final F1-score of a kind of query after part of its tests have been evaluated.
+         * @param correct The number of evaluated tests that passed.
+         * @param incorrect The number of evaluated tests that failed.
+         * @param total The number of tests.
+         */
+        static F1_Bounds f1_bounds(int correct, int incorrect, int total);
+
+        /**
+         * Evaluates every query test on the simplified trajectory.
+         * @param trajectory Simplified trajectory.
+         * @return The query accuracy.
+         */
+        [[nodiscard]] Accuracy accuracy(data_structures::Trajectory const& trajectory);
+
+        /**
+         * Determines whether the simplified trajectory upholds the minimum F1-scores, evaluating only as many query
+         * tests as it takes to decide. Gives the same answer as comparing accuracy with the minimums.
+         * @param trajectory Simplified trajectory.
+         * @param min_range_f1 The minimum range query F1-score.
+         * @param min_knn_f1 The minimum KNN query F1-score.
+         * @return Whether both minimums are upheld.
+         */
+        bool accepts(data_structures::Trajectory const& trajectory, double min_range_f1, double min_knn_f1);
+
+        /**
+         * @return The number of query tests evaluated on a whole candidate by accuracy and accepts so far. Tests that
+         * are updated incrementally are counted by updated_tests.
+         */
+        [[nodiscard]] long evaluated_tests() const {
+            return evaluated;
+        }
+
+        /**
+         * @return The number of times a query test was re-checked when moving to another candidate incrementally so
+         * far. A range test is counted when its window is searched again, and a KNN test when a removed or added
+         * location passes it.
+         */
+        [[nodiscard]] long updated_tests() const {
+            return updated;
+        }
+
+    private:
+        /**
+         * The number of tests of the first chunk, which doubles with every chunk.
+         */
+        static constexpr size_t initial_chunk_size{32};
+
+        std::vector<Range_Query::Window> windows{};
+        std::vector<bool> original_in_windows{};
+        std::vector<KNN_Query_Test*> knn_tests{};
+
+        /**
+         * Keeps the tests alive.
+         */
+        std::vector<std::shared_ptr<Query>> query_objects{};
+        bool use_knn{};
+
+        /**
+         * The order in which the range and KNN tests are evaluated, by index into windows and knn_tests.
+         */
+        std::vector<size_t> range_order{};
+        std::vector<size_t> knn_order{};
+
+        /**
+         * The number of candidates on which each range and KNN test failed.
+         */
+        std::vector<int> range_failures{};
+        std::vector<int> knn_failures{};
+
+        long evaluated{};
+        long updated{};
+
+        /**
+         * Whether candidates made of original locations are evaluated incrementally.
+         */
+        bool incremental{};
+
+        std::vector<data_structures::Location> original_locations{};
+
+        /**
+         * The timestamp and coordinates that identify a location regardless of its order.
+         */
+        using Location_Key = std::tuple<unsigned long, double, double>;
+
+        /**
+         * The indices of the original locations, sorted by their keys. Of locations with the same key, the first one
+         * stands for all of them, since they answer every query alike.
+         */
+        std::vector<size_t> original_by_key{};
+
+        /**
+         * The KNN tests passed by original location i on its own are passed_tests[passed_offsets[i],
+         * passed_offsets[i + 1]), by index into knn_tests.
+         */
+        std::vector<size_t> passed_offsets{};
+        std::vector<unsigned int> passed_tests{};
+
+        /**
+         * The original locations of the current candidate, without duplicates, and whether each original location is
+         * part of it.
+         */
+        std::vector<size_t> candidate_locations{};
+        std::vector<char> in_candidate{};
+        std::vector<char> in_next_candidate{};
+
+        /**
+         * For every range test, an original location of the current candidate in its window, or
+         * Range_Query::no_location.
+         */
+        std::vector<size_t> window_locations{};
+
+        /**
+         * The number of locations of the current candidate that pass each KNN test on their own.
+         */
+        std::vector<int> passing_locations{};
+
+        int correct_range_queries{};
+        int correct_knn_queries{};
+
+        static Location_Key key_of(data_structures::Location const& location);
+
+        /**
+         * @return The index of the original location with the same timestamp and coordinates, or
+         * Range_Query::no_location if there is none.
+         */
+        [[nodiscard]] size_t find_original(data_structures::Location const& location) const;
+
+        /**
+         * Finds the KNN tests that every original location passes on its own.
+         */
+        void index_original_locations();
+
+        /**
+         * Updates the incremental state from the current candidate to the given one.
+         * @return Whether the candidate is made of original locations. Otherwise, the state is unchanged.
+         */
+        bool update_candidate(data_structures::Trajectory const& trajectory);
+
+        /**
+         * Adds (+1) or removes (-1) an original location from the current candidate in the state of the KNN tests.
+         */
+        void update_location(size_t location, int change);
+
+        /**
+         * Searches the locations of a trajectory for a location in each of the given windows, and updates the range
+         * tests of the windows.
+         * @param trajectory The locations to search.
+         * @param original_indices_of_trajectory The original location of every location of the trajectory.
+         * @param tests The range tests to update, by index into windows.
+         */
+        void update_windows(data_structures::Trajectory const& trajectory,
+                            std::vector<size_t> const& original_indices_of_trajectory,
+                            std::vector<size_t> const& tests);
+
+        /**
+         * @return The query accuracy of the current candidate.
+         */
+        [[nodiscard]] Accuracy current_accuracy() const;
+
+        /**
+         * Evaluates the range tests range_order[begin, end).
+         * @return The number of tests that passed.
+         */
+        int evaluate_range(data_structures::Trajectory const& trajectory, size_t begin, size_t end);
+
+        /**
+         * Evaluates the KNN tests knn_order[begin, end) concurrently.
+         * @return The number of tests that passed.
+         */
+        int evaluate_knn(data_structures::Trajectory const& trajectory, size_t begin, size_t end);
+
+        /**
+         * Evaluates the tests of one kind in chunks until the F1-score is decided.
+         * @return Whether the F1-score upholds the minimum.
+         */
+        template<typename Evaluate>
+        bool decide(size_t total, double min_f1, Evaluate evaluate);
+
+        /**
+         * Moves the tests that failed most often to the front.
+         */
+        static void reorder(std::vector<size_t>& order, std::vector<int> const& failures);
+    };
+
+} // spatial_queries
+
+#endif //TRACE_Q_QUERY_EVALUATOR_HPP
@@ -1,22 +1,144 @@
 #include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <sstream>
 #include <limits>
 #include <pqxx/pqxx>
 #include "Range_Query.hpp"
+#include "../database/Connection_Pool.hpp"
 
 namespace spatial_queries {
 
-    std::string Range_Query::connection_string {"user=postgres password=postgres host=localhost dbname=traceq port=5432"};
+    namespace {
+        /**
+         * One axis of the uniform grid used by in_range_batch.
+         */
+        struct Grid_Axis {
+            double low{};
+            double cell_width{};
+            size_t cells{1};
+
+            Grid_Axis(double low, double high, double mean_extent, size_t max_cells) : low{low} {
+                // Cells about as wide as the average window keep the number of cells each window covers small
+                if (high > low && mean_extent > 0) {
+                    cells = std::clamp(static_cast<size_t>(std::ceil((high - low) / mean_extent)), size_t{1}, max_cells);
+                }
+                cell_width = (high - low) / static_cast<double>(cells);
+            }
+
+            /**
+             * The cell containing the value, clamped to the grid. Monotone, so a value within [a, b] is in a cell
+             * between the cells of a and b.
+             */
+            [[nodiscard]] size_t cell(double value) const {
+                if (cells == 1) {
+                    return 0;
+                }
+                auto position = std::floor((value - low) / cell_width);
+                return static_cast<size_t>(std::clamp(position, 0.0, static_cast<double>(cells - 1)));
+            }
+        };
+    }
 
     bool Range_Query::in_range(data_structures::Trajectory const& trajectory, Window const& window) {
         return std::ranges::any_of(std::cbegin(trajectory.locations), std::cend(trajectory.locations),
                                    [&window](data_structures::Location const& loc){
-                                       return loc.longitude >= window.x_low && loc.longitude <= window.x_high
-                                              && loc.latitude >= window.y_low && loc.latitude <= window.y_high
-                                              && loc.timestamp >= window.t_low && loc.timestamp <= window.t_high;
+                                       return contains(window, loc);
                                    });
     }
 
+    std::vector<bool> Range_Query::in_range_batch(data_structures::Trajectory const& trajectory,
+                                                  std::vector<Window> const& windows) {
+        auto locations = find_in_range_batch(trajectory, windows);
+        std::vector<bool> result(windows.size(), false);
+        for (size_t i = 0; i < locations.size(); ++i) {
+            result[i] = locations[i] != no_location;
+        }
+        return result;
+    }
+
+    std::vector<size_t> Range_Query::find_in_range_batch(data_structures::Trajectory const& trajectory,
+                                                         std::vector<Window> const& windows) {
+        std::vector<size_t> result(windows.size(), no_location);
+        if (windows.empty() || trajectory.locations.empty()) {
+            return result;
+        }
+
+        auto [x_min, x_max] = std::ranges::minmax(trajectory.locations, {}, &data_structures::Location::longitude);
+        auto [y_min, y_max] = std::ranges::minmax(trajectory.locations, {}, &data_structures::Location::latitude);
+        double x_low = x_min.longitude, x_high = x_max.longitude;
+        double y_low = y_min.latitude, y_high = y_max.latitude;
+
+        // Windows that miss the bounding box of the trajectory cannot contain any of its locations
+        std::vector<size_t> candidates{};
+        candidates.reserve(windows.size());
+        double x_extent_sum{};
+        double y_extent_sum{};
+        for (size_t i = 0; i < windows.size(); ++i) {
+            auto const& window = windows[i];
+            if (window.x_low > x_high || window.x_high < x_low || window.y_low > y_high || window.y_high < y_low
+                || window.t_low > window.t_high) {
+                continue;
+            }
+            candidates.push_back(i);
+            x_extent_sum += std::min(window.x_high, x_high) - std::max(window.x_low, x_low);
+            y_extent_sum += std::min(window.y_high, y_high) - std::max(window.y_low, y_low);
+        }
+        if (candidates.empty()) {
+            return result;
+        }
+
+        auto count = static_cast<double>(candidates.size());
+        auto max_cells = static_cast<size_t>(std::ceil(std::sqrt(count)));
+        Grid_Axis x_axis{x_low, x_high, x_extent_sum / count, max_cells};
+        Grid_Axis y_axis{y_low, y_high, y_extent_sum / count, max_cells};
+
+        // The locations are swept in time order, and a window is only registered in its cells once the sweep reaches
+        // its start time. Windows that have ended or have been hit are dropped from a cell when they are encountered.
+        std::vector<size_t> by_time(trajectory.size());
+        std::iota(by_time.begin(), by_time.end(), 0);
+        if (!std::ranges::is_sorted(trajectory.locations, {}, &data_structures::Location::timestamp)) {
+            std::ranges::stable_sort(by_time, {}, [&trajectory](size_t i) { return trajectory[i].timestamp; });
+        }
+        std::ranges::sort(candidates, {}, [&windows](size_t i) { return windows[i].t_low; });
+
+        std::vector<std::vector<size_t>> cells(x_axis.cells * y_axis.cells);
+        size_t next_candidate = 0;
+        for (auto location_index : by_time) {
+            auto const& loc = trajectory[location_index];
+            for (; next_candidate < candidates.size()
+                   && windows[candidates[next_candidate]].t_low <= loc.timestamp; ++next_candidate) {
+                auto i = candidates[next_candidate];
+                auto const& window = windows[i];
+                if (window.t_high < loc.timestamp) {
+                    continue; // Ended between two locations
+                }
+                auto x_last = x_axis.cell(window.x_high);
+                auto y_last = y_axis.cell(window.y_high);
+                for (auto x = x_axis.cell(window.x_low); x <= x_last; ++x) {
+                    for (auto y = y_axis.cell(window.y_low); y <= y_last; ++y) {
+                        cells[x * y_axis.cells + y].push_back(i);
+                    }
+                }
+            }
+
+            auto& cell = cells[x_axis.cell(loc.longitude) * y_axis.cells + y_axis.cell(loc.latitude)];
+            for (size_t j = 0; j < cell.size();) {
+                auto i = cell[j];
+                if (result[i] == no_location && contains(windows[i], loc)) {
+                    result[i] = location_index;
+                }
+                if (result[i] != no_location || windows[i].t_high < loc.timestamp) {
+                    cell[j] = cell.back();
+                    cell.pop_back();
+                    continue;
+                }
+                ++j;
+            }
+        }
+        return result;
+    }
+
     std::unordered_set<unsigned int> spatial_queries::Range_Query::get_ids_from_range_query(
             std::string const& table, Window const& window) {
         std::stringstream query{};
@@ -42,8 +164,8 @@ namespace spatial_queries {
         }
         query << ";";
 
-        pqxx::connection c{connection_string};
-        pqxx::work txn{c};
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
 
         auto ids = txn.query<int>(query.str());
 
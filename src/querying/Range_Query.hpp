@@ -5,6 +5,7 @@
 #include "../data/Trajectory.hpp"
 #include <unordered_set>
 #include <limits>
+#include <vector>
 
 namespace spatial_queries {
 
@@ -18,6 +19,18 @@ namespace spatial_queries {
             unsigned long t_high{ std::numeric_limits<unsigned long>::max() };
         };
 
+        /**
+         * Determines whether the given location is in the window.
+         * @param window The window wherein the location is tested for presence.
+         * @param location The location to check whether is in the window.
+         * @return A boolean value determining whether the given location is in the window.
+         */
+        static bool contains(Window const& window, data_structures::Location const& location) {
+            return location.longitude >= window.x_low && location.longitude <= window.x_high
+                   && location.latitude >= window.y_low && location.latitude <= window.y_high
+                   && location.timestamp >= window.t_low && location.timestamp <= window.t_high;
+        }
+
         /**
          * Determines whether the given trajectory is in the window.
          * @param trajectory Trajectory to check whether is in the window.
@@ -26,6 +39,34 @@ namespace spatial_queries {
          */
         static bool in_range(data_structures::Trajectory const& trajectory, Window const& window);
 
+        /**
+         * Determines for every window whether the given trajectory is in it, in a single pass over the trajectory.
+         * The locations are swept in time order while the windows whose time interval contains the sweep are registered
+         * in the cells of a uniform grid over the trajectory's bounding box. Each location is therefore only tested
+         * against the current windows overlapping its cell, and a window is no longer tested once it is hit.
+         * @param trajectory Trajectory to check whether is in the windows.
+         * @param windows The windows wherein the trajectory is tested for presence.
+         * @return For every window, in the same order, whether the given trajectory is in it.
+         */
+        static std::vector<bool> in_range_batch(data_structures::Trajectory const& trajectory,
+                                                std::vector<Window> const& windows);
+
+        /**
+         * Marks a window that contains no location of the trajectory in the result of find_in_range_batch.
+         */
+        static constexpr size_t no_location{std::numeric_limits<size_t>::max()};
+
+        /**
+         * Finds a location of the given trajectory in every window, in a single pass over the trajectory like
+         * in_range_batch.
+         * @param trajectory Trajectory whose locations are searched for in the windows.
+         * @param windows The windows wherein the trajectory is tested for presence.
+         * @return For every window, in the same order, the index of one of the trajectory's locations in it, or
+         * no_location.
+         */
+        static std::vector<size_t> find_in_range_batch(data_structures::Trajectory const& trajectory,
+                                                       std::vector<Window> const& windows);
+
         /**
          * Performs a range query on the given database given a window.
          * @param table The table to query.
@@ -33,12 +74,6 @@ namespace spatial_queries {
          * @return A list of trajectory IDs corresponding to the range query using the given window.
          */
         static std::unordered_set<unsigned int> get_ids_from_range_query(std::string const& table, Window const& window);
-
-    private:
-        /**
-         * The connection string that specifies the connection details for the PostgreSQL database.
-         */
-        static std::string connection_string;
     };
 
 } // spatial_queries
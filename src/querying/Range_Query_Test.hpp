@@ -43,6 +43,10 @@ namespace spatial_queries {
          */
         bool operator()(data_structures::Trajectory const& trajectory) override;
 
+        [[nodiscard]] Range_Query::Window const& get_window() const {
+            return window;
+        }
+
         ~Range_Query_Test() override = default;
 
     };
@@ -0,0 +1,74 @@
+#include <cmath>
+#include "DAD_Oracle.hpp"
+
+namespace simp_algorithms {
+
+    namespace {
+        struct Direction {
+            double cos{};
+            double sin{};
+            bool valid{};
+        };
+
+        /**
+         * The unit direction from one location to another, which is invalid if the locations coincide.
+         */
+        Direction direction(data_structures::Location const& from, data_structures::Location const& to) {
+            auto delta_x = to.longitude - from.longitude;
+            auto delta_y = to.latitude - from.latitude;
+            auto length = std::hypot(delta_x, delta_y);
+            if (length == 0) {
+                return {};
+            }
+            return {delta_x / length, delta_y / length, true};
+        }
+    }
+
+    DAD_Oracle::DAD_Oracle(Trajectory const& trajectory) : trajectory{trajectory} {
+        prefix_sums.reserve(trajectory.size());
+        prefix_sums.emplace_back();
+
+        for (size_t k = 1; k < trajectory.size(); ++k) {
+            auto edge = direction(trajectory[k - 1], trajectory[k]);
+            auto sums = prefix_sums.back();
+            sums.edges += edge.valid ? 1 : 0;
+            sums.cos += edge.cos;
+            sums.sin += edge.sin;
+            prefix_sums.push_back(sums);
+        }
+    }
+
+    double DAD_Oracle::operator()(int i, int j) const {
+        if (j - i <= 1) {
+            return 0;
+        }
+
+        // The edges between i and j start at location index i - 1 to j - 2
+        auto const& low = prefix_sums[i - 1];
+        auto const& high = prefix_sums[j - 1];
+        auto segment = direction(trajectory[i - 1], trajectory[j - 1]);
+
+        auto error = (high.edges - low.edges) - (segment.cos * (high.cos - low.cos) + segment.sin * (high.sin - low.sin));
+
+        // Rounding may leave a tiny negative residue where every edge is parallel to the segment.
+        return error > 0 ? error : 0;
+    }
+
+    double DAD_Oracle::direct_sum(Trajectory const& trajectory, int i, int j) {
+        // Here we subtract one from both i and j, due to 0-indexing
+        i = i - 1;
+        j = j - 1;
+        auto segment = direction(trajectory[i], trajectory[j]);
+
+        double res{};
+        for (int k = i; k < j; ++k) {
+            auto edge = direction(trajectory[k], trajectory[k + 1]);
+            if (edge.valid) {
+                res += 1 - (segment.cos * edge.cos + segment.sin * edge.sin);
+            }
+        }
+
+        return res;
+    }
+
+} // simp_algorithms
@@ -0,0 +1,73 @@
+#ifndef TRACE_Q_DAD_ORACLE_HPP
+#define TRACE_Q_DAD_ORACLE_HPP
+
+#include <string_view>
+#include <vector>
+#include "../data/Trajectory.hpp"
+
+namespace simp_algorithms {
+
+    /**
+     * Answers direction-aware distance (DAD) sum queries over sub-ranges of a single trajectory in constant time.
+     * The DAD of the original edges between i and j is the sum of 1 - cos(d) over every edge, where d is the angle
+     * between the edge and the segment from i to j. This is zero when every edge has the heading of the segment and
+     * grows smoothly to two for edges in the opposite direction.
+     * Since cos(a - b) = cos(a)cos(b) + sin(a)sin(b), prefix sums of the unit direction of every edge are enough.
+     * Edges of zero length have no direction and are ignored, and a segment of zero length counts every edge as
+     * perpendicular.
+     */
+    class DAD_Oracle {
+        using Trajectory = data_structures::Trajectory;
+
+        /**
+         * Cumulative sums over the edges preceding a given index.
+         */
+        struct Prefix_Sums {
+            int edges{};
+            double cos{};
+            double sin{};
+        };
+
+        /**
+         * The trajectory the oracle answers queries for. It must outlive the oracle.
+         */
+        Trajectory const& trajectory;
+
+        /**
+         * prefix_sums[k] holds the sums over the edges from location index 0 to k, which are k edges in total.
+         */
+        std::vector<Prefix_Sums> prefix_sums{};
+
+    public:
+        /**
+         * The name of the metric, which identifies it in the description of MRPA.
+         */
+        static constexpr std::string_view name{"dad"};
+
+        /**
+         * Precomputes the prefix sums for the given trajectory in a single pass.
+         * @param trajectory The trajectory that queries will be answered for.
+         */
+        explicit DAD_Oracle(Trajectory const& trajectory);
+
+        /**
+         * Calculates the DAD error sum over a range of the trajectory.
+         * @param i Start of the range (point order, 1-indexed).
+         * @param j End of the range (point order, 1-indexed).
+         * @return The DAD error sum of the edges between i and j, or zero if there are no points between them.
+         */
+        [[nodiscard]] double operator()(int i, int j) const;
+
+        /**
+         * Reference implementation that sums the DAD error of every edge between i and j.
+         * @param trajectory The input trajectory.
+         * @param i Start of the range (point order, 1-indexed).
+         * @param j End of the range (point order, 1-indexed).
+         * @return The DAD error sum of the edges between i and j.
+         */
+        static double direct_sum(Trajectory const& trajectory, int i, int j);
+    };
+
+} // simp_algorithms
+
+#endif //TRACE_Q_DAD_ORACLE_HPP
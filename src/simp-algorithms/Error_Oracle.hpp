@@ -0,0 +1,25 @@
+#ifndef TRACE_Q_ERROR_ORACLE_HPP
+#define TRACE_Q_ERROR_ORACLE_HPP
+
+#include <concepts>
+#include <string_view>
+#include "../data/Trajectory.hpp"
+
+namespace simp_algorithms {
+
+    /**
+     * An error metric for MRPA. An oracle is constructed from a trajectory, and oracle(i, j) returns the error of
+     * approximating the points strictly between the orders i and j by the segment from i to j.
+     * The error must be non-negative, and zero when there are no points between i and j.
+     * The static member name identifies the metric.
+     */
+    template<typename T>
+    concept Error_Oracle = std::constructible_from<T, data_structures::Trajectory const&>
+            && requires(T const& oracle, int i, int j) {
+                { oracle(i, j) } -> std::convertible_to<double>;
+                { T::name } -> std::convertible_to<std::string_view>;
+            };
+
+} // simp_algorithms
+
+#endif //TRACE_Q_ERROR_ORACLE_HPP
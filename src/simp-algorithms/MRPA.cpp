@@ -2,31 +2,32 @@
 #include <stdexcept>
 #include <algorithm>
 #include <ranges>
-#include <queue>
-#include <deque>
 #include <iostream>
-#include <unordered_map>
+#include <future>
+#include <numeric>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 #include "MRPA.hpp"
+#include "../concurrency/Work_Stealing_Pool.hpp"
 
 namespace simp_algorithms {
 
-    std::vector<std::pair<data_structures::Trajectory, double>> MRPA::run_get_error_tolerances(data_structures::Trajectory const& trajectory) const {
+    template<Error_Oracle Oracle>
+    std::vector<std::pair<data_structures::Trajectory, double>> Basic_MRPA<Oracle>::run_get_error_tolerances(data_structures::Trajectory const& trajectory) const {
         if(resolution_scale > static_cast<double>(trajectory.size())) {
             throw std::invalid_argument("resolution_scale is larger than the trajectory's size");
         }
 
-        std::vector<std::pair<Trajectory, double>> result{};
-        auto error_tolerances = MRPA::error_tolerance_init(trajectory);
+        Oracle oracle{trajectory};
+        auto error_tolerances = error_tolerance_init(trajectory, oracle);
+        auto levels = simplify_levels(trajectory, oracle, error_tolerances);
 
+        std::vector<std::pair<Trajectory, double>> result{};
         auto largest_error_tolerance = error_tolerances.back();
-        auto first_tree = init_tree(trajectory, error_tolerances[0], error_tolerances[1]);
-        auto first_approx = approximate(trajectory, first_tree, error_tolerances[0]);
-        result.emplace_back(first_approx, 1-(error_tolerances[0]/largest_error_tolerance));
-
-        for (int i = 1; i < error_tolerances.size(); ++i) {
-            auto tree = apply_error_tolerance_scale_to_tree(result.back().first, i, error_tolerances);
-            auto approximation = approximate(result.back().first, tree, error_tolerances[i]);
-            result.emplace_back(approximation, 1-(error_tolerances[i]/largest_error_tolerance));
+        for (int i = 0; i < levels.size(); ++i) {
+            result.emplace_back(std::move(levels[i]), 1-(error_tolerances[i]/largest_error_tolerance));
         }
 
         // Remove duplicates that may occur with very small resolution scales
@@ -40,23 +41,24 @@ namespace simp_algorithms {
 
     }
 
-    std::vector<data_structures::Trajectory> MRPA::operator()(Trajectory const& trajectory) const {
+    template<Error_Oracle Oracle>
+    std::string Basic_MRPA<Oracle>::description() const {
+        std::stringstream result{};
+        result << std::setprecision(std::numeric_limits<double>::max_digits10)
+               << "mrpa(metric=" << Oracle::name << ",resolution_scale=" << resolution_scale
+               << ",mode=" << (mode == Mode::cascading ? "cascading" : "independent") << ")";
+        return result.str();
+    }
+
+    template<Error_Oracle Oracle>
+    std::vector<data_structures::Trajectory> Basic_MRPA<Oracle>::operator()(Trajectory const& trajectory) const {
         if(resolution_scale > static_cast<double>(trajectory.size())) {
             throw std::invalid_argument("resolution_scale is larger than the trajectory's size");
         }
 
-        std::vector<Trajectory> result{};
-        auto error_tolerances = MRPA::error_tolerance_init(trajectory);
-
-        auto first_tree = init_tree(trajectory, error_tolerances[0], error_tolerances[1]);
-        auto first_approx = approximate(trajectory, first_tree, error_tolerances[0]);
-        result.emplace_back(first_approx);
-
-        for (int i = 1; i < error_tolerances.size(); ++i) {
-            auto tree = apply_error_tolerance_scale_to_tree(result.back(), i, error_tolerances);
-            auto approximation = approximate(result.back(), tree, error_tolerances[i]);
-            result.emplace_back(approximation);
-        }
+        Oracle oracle{trajectory};
+        auto error_tolerances = error_tolerance_init(trajectory, oracle);
+        auto result = simplify_levels(trajectory, oracle, error_tolerances);
 
         // Remove duplicates that may occur with very small resolution scales
         for (auto i = static_cast<int>(result.size() - 1); i > 0; i--) {
@@ -68,101 +70,182 @@ namespace simp_algorithms {
         return result;
     }
 
+    template<Error_Oracle Oracle>
+    std::vector<double> Basic_MRPA<Oracle>::error_tolerances(Trajectory const& trajectory) const {
+        if(resolution_scale > static_cast<double>(trajectory.size())) {
+            throw std::invalid_argument("resolution_scale is larger than the trajectory's size");
+        }
 
-    std::vector<double> MRPA::error_tolerance_init(Trajectory const& trajectory) const {
-        std::vector<double> result{};
+        Oracle oracle{trajectory};
+        return error_tolerance_init(trajectory, oracle);
+    }
 
-        auto number_of_tolerances = std::floor(std::log(trajectory.size()) /
-                std::log(resolution_scale));
+    template<Error_Oracle Oracle>
+    data_structures::Trajectory Basic_MRPA<Oracle>::simplify_at(Trajectory const& trajectory, double error_tolerance) const {
+        Oracle oracle{trajectory};
+        auto tree = init_tree(trajectory, oracle, error_tolerance, error_tolerance * resolution_scale);
+        return approximate(trajectory, oracle, tree, error_tolerance);
+    }
 
-        for (auto k = 1; k <= number_of_tolerances; k++) {
-            // Here we add 1 to the resolution and floor it in order to handle cases where the resolution
-            // calculation is exactly an int.
-            auto resolution = std::floor(static_cast<double>(trajectory.size()) /
-                    std::pow(resolution_scale, k) + 1);
-            double error_tolerance{};
+    template<Error_Oracle Oracle>
+    std::vector<data_structures::Trajectory> Basic_MRPA<Oracle>::simplify_with_tolerances(
+            Trajectory const& trajectory, std::vector<double> const& error_tolerances) const {
+        Oracle oracle{trajectory};
+        return simplify_levels(trajectory, oracle, error_tolerances);
+    }
 
-            for (auto j = 1; j < resolution; j++) {
-                auto range_start = static_cast<int>(std::floor((static_cast<double>(trajectory.size() - 1)) /
-                        (resolution - 1) * (j - 1) + 1));
-                auto range_end = static_cast<int>(std::floor((static_cast<double>(trajectory.size() - 1)) /
-                        (resolution - 1) * j + 1));
+    template<Error_Oracle Oracle>
+    std::vector<Timed_Simplification> Basic_MRPA<Oracle>::simplify_all(std::span<Trajectory const> trajectories) const {
+        std::vector<size_t> indices(trajectories.size());
+        std::iota(indices.begin(), indices.end(), 0);
+        // Tree construction and approximation grow quadratically with the size in the worst case
+        std::ranges::stable_sort(indices, std::greater{}, [&](size_t index) {
+            auto size = static_cast<double>(trajectories[index].size());
+            return size * size;
+        });
+
+        auto& pool = concurrency::Work_Stealing_Pool::shared();
+        std::vector<std::future<Timed_Simplification>> futures(trajectories.size());
+        for (auto index : indices) {
+            futures[index] = pool.submit([this, &trajectory = trajectories[index]]() {
+                auto start = std::chrono::steady_clock::now();
+                auto simplifications = (*this)(trajectory);
+                return Timed_Simplification{std::move(simplifications), std::chrono::steady_clock::now() - start};
+            });
+        }
 
-                if (j == resolution - 1 && range_end < trajectory.size()) {
-                    range_end = static_cast<int>(trajectory.size());
-                }
+        // The tasks refer to the trajectories, so all of them must finish before an exception leaves this scope
+        for (auto& future : futures) {
+            pool.wait(future);
+        }
+        std::vector<Timed_Simplification> result{};
+        result.reserve(trajectories.size());
+        for (auto& future : futures) {
+            result.emplace_back(future.get());
+        }
+        return result;
+    }
 
-                error_tolerance += error_SED_sum(trajectory, range_start, range_end);
+    template<Error_Oracle Oracle>
+    std::vector<data_structures::Trajectory> Basic_MRPA<Oracle>::simplify_levels(Trajectory const& trajectory,
+                                                                   Oracle const& oracle,
+                                                                   std::vector<double> const& error_tolerances) const {
+        std::vector<Trajectory> result{};
+        result.reserve(error_tolerances.size());
+
+        if (mode == Mode::independent) {
+            // Every level only reads the original trajectory and its oracle, so the levels can run concurrently
+            auto& pool = concurrency::Work_Stealing_Pool::shared();
+            std::vector<std::future<Trajectory>> futures{};
+            futures.reserve(error_tolerances.size());
+            for (int i = 0; i < error_tolerances.size(); ++i) {
+                futures.emplace_back(pool.submit([&trajectory, &oracle, &error_tolerances](int index) {
+                    auto tree = apply_error_tolerance_scale_to_tree(trajectory, oracle, index, error_tolerances);
+                    return approximate(trajectory, oracle, tree, error_tolerances[index]);
+                }, i));
             }
-
-            error_tolerance *= 1 / (resolution - 1);
-            if (result.empty() || result.back() != error_tolerance) {
-                result.emplace_back(error_tolerance);
+            for (auto& future : futures) {
+                pool.wait(future);
             }
+            for (auto& future : futures) {
+                result.emplace_back(future.get());
+            }
+            return result;
+        }
+
+        auto first_tree = apply_error_tolerance_scale_to_tree(trajectory, oracle, 0, error_tolerances);
+        result.emplace_back(approximate(trajectory, oracle, first_tree, error_tolerances[0]));
+
+        for (int i = 1; i < error_tolerances.size(); ++i) {
+            auto const& previous = result.back();
+            Oracle previous_oracle{previous};
+            auto tree = apply_error_tolerance_scale_to_tree(previous, previous_oracle, i, error_tolerances);
+            auto approximation = approximate(previous, previous_oracle, tree, error_tolerances[i]);
+            result.emplace_back(std::move(approximation));
         }
 
-        std::ranges::sort(result);
         return result;
     }
 
 
-    double MRPA::error_SED_sum(const Trajectory& trajectory, int i, int j) {
+    template<Error_Oracle Oracle>
+    std::vector<double> Basic_MRPA<Oracle>::error_tolerance_init(Trajectory const& trajectory, Oracle const& oracle) const {
+        std::vector<double> result{};
 
-        // Here we subtract one from both i and j, due to 0-indexing
-        i = i - 1;
-        j = j - 1;
-        auto approx_trajectory = approximated_temporally_synchronized_position(trajectory, i, j);
-        double res {};
-        for (int k = i + 1; k < j; ++k) {
-            // Here we index the approx trajectory with the difference of k and i+1.
-            // This is because the approx trajectory does not have as many points,
-            // therefore it does not have values in the same indexes as the original trajectory.
-            res += pow(single_SED(trajectory[k], approx_trajectory[k - (i + 1)]), 2);
+        auto number_of_tolerances = static_cast<int>(std::floor(std::log(trajectory.size()) /
+                std::log(resolution_scale)));
+
+        std::vector<double> level_tolerances(number_of_tolerances);
+        if (trajectory.size() >= parallel_tolerance_threshold) {
+            auto& pool = concurrency::Work_Stealing_Pool::shared();
+            std::vector<std::future<double>> futures{};
+            futures.reserve(number_of_tolerances);
+            for (auto k = 1; k <= number_of_tolerances; k++) {
+                futures.emplace_back(pool.submit([this, &trajectory, &oracle](int level) {
+                    return level_error_tolerance(trajectory, oracle, level);
+                }, k));
+            }
+            for (auto k = 1; k <= number_of_tolerances; k++) {
+                level_tolerances[k - 1] = pool.get(futures[k - 1]);
+            }
+        }
+        else {
+            for (auto k = 1; k <= number_of_tolerances; k++) {
+                level_tolerances[k - 1] = level_error_tolerance(trajectory, oracle, k);
+            }
         }
 
-        return res;
-    }
-
-
-    data_structures::Trajectory MRPA::approximated_temporally_synchronized_position(Trajectory const& trajectory,
-                                                                                    int i, int j) {
-        Trajectory res {};
-
-        for (int k = i + 1; k < j; ++k) {
-            auto x = static_cast<double>(trajectory[i].longitude +
-                     (static_cast<long double>(trajectory[k].timestamp - trajectory[i].timestamp) /
-                     static_cast<long double>((trajectory[j].timestamp - trajectory[i].timestamp))) *
-                     (trajectory[j].longitude - trajectory[i].longitude));
-            auto y = static_cast<double>(trajectory[i].latitude +
-                     (static_cast<long double>(trajectory[k].timestamp - trajectory[i].timestamp) /
-                     static_cast<long double>((trajectory[j].timestamp - trajectory[i].timestamp))) *
-                     (trajectory[j].latitude - trajectory[i].latitude));
-            res.locations.emplace_back(trajectory[k].order, trajectory[k].timestamp, x, y);
+        for (auto error_tolerance : level_tolerances) {
+            if (result.empty() || result.back() != error_tolerance) {
+                result.emplace_back(error_tolerance);
+            }
         }
 
-        return res;
+        std::ranges::sort(result);
+        return result;
     }
 
+    template<Error_Oracle Oracle>
+    double Basic_MRPA<Oracle>::level_error_tolerance(Trajectory const& trajectory, Oracle const& oracle, int k) const {
+        // Here we add 1 to the resolution and floor it in order to handle cases where the resolution
+        // calculation is exactly an int.
+        auto resolution = std::floor(static_cast<double>(trajectory.size()) /
+                std::pow(resolution_scale, k) + 1);
+        double error_tolerance{};
+
+        for (auto j = 1; j < resolution; j++) {
+            auto range_start = static_cast<int>(std::floor((static_cast<double>(trajectory.size() - 1)) /
+                    (resolution - 1) * (j - 1) + 1));
+            auto range_end = static_cast<int>(std::floor((static_cast<double>(trajectory.size() - 1)) /
+                    (resolution - 1) * j + 1));
+
+            if (j == resolution - 1 && range_end < trajectory.size()) {
+                range_end = static_cast<int>(trajectory.size());
+            }
+
+            error_tolerance += oracle(range_start, range_end);
+        }
 
-    double MRPA::single_SED(Location const& original_point, Location const& approx_point) {
-        return sqrt(pow(original_point.longitude - approx_point.longitude, 2)
-        + pow(original_point.latitude - approx_point.latitude, 2));
+        error_tolerance *= 1 / (resolution - 1);
+        return error_tolerance;
     }
 
 
-    data_structures::Node<data_structures::Location> MRPA::init_tree(Trajectory const& trajectory,
-                                                             double error_tol, double high_error_tol) {
+    template<Error_Oracle Oracle>
+    data_structures::Flat_Tree Basic_MRPA<Oracle>::init_tree(Trajectory const& trajectory,
+                                                                     Oracle const& oracle,
+                                                                     double error_tol, double high_error_tol) {
 
-        MRPA_PTQ working_list{compare};
-        working_list.push(trajectory.locations.front());
-        MRPA_PTQ future_work(compare);
-        std::vector<Location> unvisited{trajectory.locations.begin() + 1, trajectory.locations.end()};
+        MRPA_PTQ working_list{};
+        working_list.push(trajectory.locations.front().order);
+        MRPA_PTQ future_work{};
+        Frontier unvisited{trajectory.locations.front().order + 1, trajectory.locations.back().order};
 
-        Node root{working_list.top()};
+        Tree tree{trajectory.locations.front().order, trajectory.size()};
 
         while (!unvisited.empty()) {
             while (!working_list.empty()) {
-                maintain_priority_queue(root, trajectory, error_tol, high_error_tol, working_list,
+                maintain_priority_queue(tree, oracle, error_tol, high_error_tol, working_list,
                                         future_work, unvisited);
             }
 
@@ -173,33 +256,24 @@ namespace simp_algorithms {
             }
         }
 
-        return root;
+        return tree;
     }
 
 
-    void MRPA::maintain_priority_queue(Node& tree, Trajectory const& trajectory, double error_tol,
-                                       double high_error_tol, MRPA_PTQ& working_list, MRPA_PTQ& future_work,
-                                       std::vector<Location>& unvisited) {
-        Location index1 = working_list.top();
+    template<Error_Oracle Oracle>
+    void Basic_MRPA<Oracle>::maintain_priority_queue(Tree& tree, Oracle const& oracle,
+                                       double error_tol, double high_error_tol, MRPA_PTQ& working_list,
+                                       MRPA_PTQ& future_work, Frontier& unvisited) {
+        auto index1 = static_cast<int>(working_list.top());
         working_list.pop();
 
-        for (int i = 0; i < unvisited.size(); ++i) {
-            const auto index2 = unvisited[i];
-            if (index2.order < index1.order) {
-                continue;
-            }
-            auto error = MRPA::error_SED_sum(trajectory, index1.order, index2.order);
+        // Only vertices of higher order than index1 can become its children
+        for (auto index2 = unvisited.next(index1 + 1); index2 != unvisited.end(); index2 = unvisited.next(index2 + 1)) {
+            auto error = oracle(index1, index2);
             if (error <= error_tol) {
-                unvisited.erase(unvisited.cbegin() + i);
-                i--; // decrement i because of erase
-                future_work.push(index2);
-                auto& parent = tree.find(index1);
-                if (parent.data.order == -1) {
-                    throw std::runtime_error("dummy node was returned");
-                }
-                auto child = Node(index2);
-                parent.children.emplace_back(child);
-                child.parent = std::make_shared<Node>(parent);
+                unvisited.erase(index2);
+                future_work.push(static_cast<std::uint32_t>(index2));
+                tree.add_child(index1, index2);
             }
             else if (error > high_error_tol) {
                 break;
@@ -209,44 +283,62 @@ namespace simp_algorithms {
     }
 
 
-    data_structures::Trajectory MRPA::approximate(const Trajectory& trajectory, const Node& tree, double error_tol) {
+    template<Error_Oracle Oracle>
+    data_structures::Trajectory Basic_MRPA<Oracle>::approximate(const Trajectory& trajectory, Oracle const& oracle,
+                                                  const Tree& tree, double error_tol) {
 
+        // Both arrays are indexed by point order - 1
         std::vector<double> approx_error(trajectory.size(), std::numeric_limits<double>::max());
         approx_error[0] = 0;
-
-        std::unordered_map<int, Location > backtrack{}; // Key is point order
-
-        auto parents = std::vector<Node>{tree};
+        std::vector<int> backtrack(trajectory.size()); // Order of the best predecessor
+
+        // The levels of the tree are processed in topological order. Every parent is relaxed against every child
+        // of the next level, so edges that are not part of the tree are considered as well. These pairs are what
+        // minimize the error of the path, so they are kept even though they cost |parents| * |children| per level.
+        std::vector<int> parents{tree.root()};
+        std::vector<int> children{};
+        parents.reserve(trajectory.size());
+        children.reserve(trajectory.size());
         auto number_output_points = 1;
 
         while(approx_error[trajectory.locations.back().order - 1] == std::numeric_limits<double>::max()) {
-            std::vector<Node> children{};
-            for(const auto& p : parents) {
-                children.insert(children.cend(), p.children.cbegin(), p.children.cend());
+            if (parents.empty()) {
+                throw std::runtime_error("The last point is not reachable in the tree");
+            }
+
+            children.clear();
+            for(const auto p : parents) {
+                auto p_children = tree.children_of(p);
+                children.insert(children.cend(), p_children.begin(), p_children.end());
             }
 
-            for (const auto& node_index1: parents) {
-                for (const auto& node_index2: children){
-                    double error = error_SED_sum(trajectory, node_index1.data.order, node_index2.data.order);
-                    if ((approx_error[node_index1.data.order - 1] + error < approx_error[node_index2.data.order - 1])
-                        && error <= error_tol) {
-                        backtrack[node_index2.data.order] = node_index1.data;
-                        approx_error[node_index2.data.order - 1] = approx_error[node_index1.data.order - 1] + error;
+            for (const auto index1: parents) {
+                auto parent_error = approx_error[index1 - 1];
+                for (const auto index2: children){
+                    // Errors are never negative, so a child that is already reached as cheaply cannot improve
+                    if (parent_error >= approx_error[index2 - 1]) {
+                        continue;
+                    }
+                    double error = oracle(index1, index2);
+                    if ((parent_error + error < approx_error[index2 - 1]) && error <= error_tol) {
+                        backtrack[index2 - 1] = index1;
+                        approx_error[index2 - 1] = parent_error + error;
                     }
                 }
             }
 
-            parents = std::move(children);
+            std::swap(parents, children);
             number_output_points++;
         }
 
-        std::deque<Location > result{trajectory.locations.back()};
-
-        for (int i = number_output_points; i >= 2; --i) {
-            result.push_front(backtrack[result.front().order]);
+        std::vector<Location> result(number_output_points);
+        auto order = trajectory.locations.back().order;
+        for (int i = number_output_points - 1; i >= 0; --i) {
+            result[i] = trajectory[order - 1];
+            order = backtrack[order - 1];
         }
 
-        Trajectory result_trajectory{trajectory.id, {std::begin(result), std::end(result)}};
+        Trajectory result_trajectory{trajectory.id, std::move(result)};
 
         // Before returning we must update the order values of the nodes.
         // This is because we use order to index, and since we return a trajectory with fewer points,
@@ -259,16 +351,26 @@ namespace simp_algorithms {
     }
 
 
-    data_structures::Node<data_structures::Location> MRPA::apply_error_tolerance_scale_to_tree(
-            Trajectory const& trajectory, int index, const std::vector<double>& error_tolerances) {
+    template<Error_Oracle Oracle>
+    data_structures::Flat_Tree Basic_MRPA<Oracle>::apply_error_tolerance_scale_to_tree(
+            Trajectory const& trajectory, Oracle const& oracle, int index,
+            const std::vector<double>& error_tolerances) {
 
+        if (error_tolerances.size() == 1) {
+            // There is no neighbouring tolerance to derive the high tolerance from
+            return init_tree(trajectory, oracle, error_tolerances[index], error_tolerances[index]);
+        }
         if (index == error_tolerances.size() - 1) {
             auto scale = error_tolerances[index] / error_tolerances[index - 1];
-            return init_tree(trajectory, error_tolerances[index], error_tolerances[index] * scale);
+            return init_tree(trajectory, oracle, error_tolerances[index], error_tolerances[index] * scale);
         }
         else {
-            return init_tree(trajectory, error_tolerances[index], error_tolerances[index + 1]);
+            return init_tree(trajectory, oracle, error_tolerances[index], error_tolerances[index + 1]);
         }
     }
 
+    template class Basic_MRPA<SED_Oracle>;
+    template class Basic_MRPA<PED_Oracle>;
+    template class Basic_MRPA<DAD_Oracle>;
+
 } // simp_algorithms
\ No newline at end of file
@@ -1,22 +1,76 @@
 #ifndef TRACE_Q_MRPA_HPP
 #define TRACE_Q_MRPA_HPP
 
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
 #include <vector>
 #include <queue>
 #include "../data/Trajectory.hpp"
-#include "../data/Node.hpp"
+#include "../data/Flat_Tree.hpp"
+#include "../data/Order_Frontier.hpp"
+#include "Error_Oracle.hpp"
+#include "SED_Oracle.hpp"
+#include "PED_Oracle.hpp"
+#include "DAD_Oracle.hpp"
+
+namespace analytics {
+    class MRPA_Stage_Benchmark;
+}
 
 namespace simp_algorithms {
 
-    class MRPA {
+    /**
+     * Describes how the resolution levels are derived from each other.
+     */
+    enum class MRPA_Mode {
+        /**
+         * Every level simplifies the output of the previous level, so the levels are computed in sequence.
+         */
+        cascading,
+        /**
+         * Every level simplifies the original trajectory, so the levels are computed concurrently on the shared
+         * work-stealing pool. The levels differ from cascading mode, since errors are measured against the original trajectory.
+         * The total work is considerably larger, as every level runs on the full trajectory, so this only pays
+         * off when many cores are available.
+         */
+        independent
+    };
+
+    /**
+     * The simplifications of one trajectory in a batch, along with the time it took to compute them.
+     */
+    struct Timed_Simplification {
+        std::vector<data_structures::Trajectory> simplifications{};
+        std::chrono::duration<double> elapsed{};
+    };
+
+    /**
+     * The MRPA algorithm, parameterized by the error metric at compile time.
+     * The oracle is constructed once per trajectory and answers error sum queries over ranges of it, such that the
+     * metric is inlined into tree construction and approximation without virtual calls.
+     * @tparam Oracle The error metric, e.g. SED_Oracle, PED_Oracle or DAD_Oracle.
+     */
+    template<Error_Oracle Oracle>
+    class Basic_MRPA {
+    public:
+        using Mode = MRPA_Mode;
+
+    private:
+        /**
+         * Times the individual stages of the algorithm in the MRPA microbenchmark.
+         */
+        friend class analytics::MRPA_Stage_Benchmark;
+
         using Trajectory = data_structures::Trajectory;
-        using Node = data_structures::Node<data_structures::Location>;
+        using Tree = data_structures::Flat_Tree;
         using Location = data_structures::Location;
-        static constexpr auto compare =
-                [](Location const &left, Location const &right) {
-            return left.order < right.order;
-        };
-        using MRPA_PTQ = std::priority_queue<Location, std::vector<Location>, decltype(compare)>;
+        using Frontier = data_structures::Order_Frontier;
+        /**
+         * Max-heap of point orders, such that the vertex of highest order is processed first.
+         */
+        using MRPA_PTQ = std::priority_queue<std::uint32_t>;
 
         /**
          * The resolution scale (called c in the MRPA paper) describes the number of the intermediate scale.
@@ -25,57 +79,54 @@ namespace simp_algorithms {
          */
         double resolution_scale {2}; // c
 
-        /**
-         * Calculates a vector of error tolerances for the given trajectory based on the resolution scale and the
-         * number of points in the trajectory, which describes the granularity of the resolution windows.
-         * @param trajectory The trajectory which for we calculate error tolerances.
-         * @return A vector of error tolerances for the given trajectory.
-         */
-        [[nodiscard]] std::vector<double> error_tolerance_init(Trajectory const& trajectory) const;
+        Mode mode {Mode::cascading};
 
         /**
-         * Calculates the sum of SED error over a range of an input trajectory.
-         * @param trajectory The input trajectory
-         * @param i Start of the range of points from the trajectory to determine the SED error sum for.
-         * @param j End of the range of points from the trajectory to determine the SED error sum for.
-         * @return The SED error sum for the range of points in the trajectory.
+         * Trajectories of at least this many points compute their error tolerances concurrently.
          */
-        static double error_SED_sum(const Trajectory& trajectory, int i, int j);
+        static constexpr size_t parallel_tolerance_threshold{2048};
 
         /**
-         * Considers both spatial and temporal information on sub-trajectories to create approximate point.
-         * @param trajectory Trajectory under approximation.
-         * @param i Start of sub-trajectory considered for approximation.
-         * @param j End of sub-trajectory considered for approximation.
-         * @return The new approximation point.
+         * Calculates a vector of error tolerances for the given trajectory based on the resolution scale and the
+         * number of points in the trajectory, which describes the granularity of the resolution windows.
+         * Every resolution level only queries the shared oracle, so for long trajectories the levels are computed
+         * concurrently. The levels are combined in the same order regardless, so the result is identical.
+         * @param trajectory The trajectory which for we calculate error tolerances.
+         * @param oracle The error oracle of the trajectory.
+         * @return A vector of error tolerances for the given trajectory.
          */
-        static Trajectory approximated_temporally_synchronized_position(Trajectory const &trajectory, int i, int j);
+        [[nodiscard]] std::vector<double> error_tolerance_init(Trajectory const& trajectory,
+                                                               Oracle const& oracle) const;
 
         /**
-         * Calculates the SED between an original point and its approximated temporal synchronized position.
-         * @param original_point The original trajectory point.
-         * @param approx_point The associated approximated trajectory point.
-         * @return The SED error (double).
+         * Calculates the error tolerance of a single resolution level, which is the average error sum over a
+         * partition of the trajectory into equally sized ranges.
+         * @param trajectory The trajectory which for we calculate the error tolerance.
+         * @param oracle The error oracle of the trajectory.
+         * @param k The resolution level, such that the partition has about |trajectory| / c^k ranges.
+         * @return The error tolerance of the resolution level.
          */
-        static double single_SED(Location const& original_point, Location const& approx_point);
+        [[nodiscard]] double level_error_tolerance(Trajectory const& trajectory, Oracle const& oracle, int k) const;
 
         /**
-         * Initializes and returns a single root node, describing a tree structure.
-         * A node consists of a parent and children, wherein the children are vertices of higher order,
-         * where the error SED sum of the trajectory points with range from the parent to the child comply
+         * Initializes and returns a tree structure over the point orders of the trajectory, rooted in the first point.
+         * The children of a vertex are vertices of higher order,
+         * where the error sum of the trajectory points with range from the parent to the child comply
          * with the error tolerance.
          * @param trajectory The trajectory from which a tree structure must be made.
+         * @param oracle The error oracle of the trajectory.
          * @param error_tol The error tolerance that determines if a child is a child of a parent node.
          * @param high_error_tol A high error tolerance, which is used to skip ahead when the error becomes too high.
          * @return The constructed tree.
          */
-        static Node init_tree(Trajectory const& trajectory, double error_tol, double high_error_tol);
+        static Tree init_tree(Trajectory const& trajectory, Oracle const& oracle, double error_tol,
+                              double high_error_tol);
 
         /**
          * Maintains the two priority queues working_list and future_work.
          * Also removes elements from unvisited and updates the tree structure.
          * @param tree The tree structure of the input trajectory.
-         * @param trajectory Trajectory to be simplified.
+         * @param oracle The error oracle of the trajectory.
          * @param error_tol The error tolerance that determines if a child is a child of a parent node.
          * @param high_error_tol A high error tolerance, which is used to skip ahead when the error becomes too high.
          * @param working_list The priority queue of vertices that are currently being processed.
@@ -83,34 +134,53 @@ namespace simp_algorithms {
          * @param unvisited The set of vertices that have not yet been visited.
          * Element are removed from this set, when they are added to future_work
          */
-        static void maintain_priority_queue(Node& tree, Trajectory const& trajectory, double error_tol,
-                                            double high_error_tol, MRPA_PTQ& working_list, MRPA_PTQ& future_work,
-                                            std::vector<Location>& unvisited);
+        static void maintain_priority_queue(Tree& tree, Oracle const& oracle,
+                                            double error_tol, double high_error_tol, MRPA_PTQ& working_list,
+                                            MRPA_PTQ& future_work, Frontier& unvisited);
 
         /**
-         *
+         * Finds the path of minimal accumulated error through the levels of the tree, using a shortest-path
+         * relaxation over flat arrays indexed by point order.
+         * Every parent of a level is relaxed against every child of the next level, not only along the tree edges.
+         * The tree fixes the number of points, and the other pairs within the error tolerance choose the path of
+         * least error among those with that many points. Following the tree edges alone costs only the length of the
+         * path, but its levels have about 9% more error on test trajectories, and the cascading levels change.
          * @param trajectory Trajectory to be simplified.
+         * @param oracle The error oracle of the trajectory.
          * @param tree Tree structure from init_tree.
          * It describes the combinations of vertices that comply with the error tolerance.
          * @param error_tol The error tolerance.
          * @return The simplified trajectory
          */
-        static Trajectory approximate(const Trajectory& trajectory, const Node& tree, double error_tol);
+        static Trajectory approximate(const Trajectory& trajectory, Oracle const& oracle, const Tree& tree,
+                                      double error_tol);
+
+        /**
+         * Computes one simplified trajectory per error tolerance according to the mode.
+         * @param trajectory The trajectory to be simplified.
+         * @param oracle The error oracle of the trajectory.
+         * @param error_tolerances The increasing error tolerances from error_tolerance_init.
+         * @return The simplified trajectories in the order of the error tolerances, including duplicates.
+         */
+        [[nodiscard]] std::vector<Trajectory> simplify_levels(Trajectory const& trajectory, Oracle const& oracle,
+                                                              std::vector<double> const& error_tolerances) const;
 
         /**
          * A helper function that ensures that init_tree is called with the correct high tolerance.
          * @param trajectory Trajectory to be simplified.
+         * @param oracle The error oracle of the trajectory.
          * @param index The current index of the error_tolerances vector.
          * @param error_tolerances The vector of increasing error tolerances
          * @return The tree structure.
          */
-        static Node apply_error_tolerance_scale_to_tree(Trajectory const& trajectory, int index,
-                                                        const std::vector<double>& error_tolerances);
+        static Tree apply_error_tolerance_scale_to_tree(Trajectory const& trajectory, Oracle const& oracle,
+                                                        int index, const std::vector<double>& error_tolerances);
 
     public:
 
-        MRPA() = default;
-        explicit MRPA(double c) : resolution_scale{c} {};
+        Basic_MRPA() = default;
+        explicit Basic_MRPA(double c) : resolution_scale{c} {};
+        Basic_MRPA(double c, Mode mode) : resolution_scale{c}, mode{mode} {};
 
         /**
          * Simplifies the input trajectory utilizing the MRPA algorithm.
@@ -119,9 +189,69 @@ namespace simp_algorithms {
          */
         std::vector<Trajectory> operator()(Trajectory const& trajectory) const;
 
+        /**
+         * @return The name of the algorithm, its error metric, resolution scale and mode, which together identify the
+         * simplifications it produces.
+         */
+        [[nodiscard]] std::string description() const;
+
         std::vector<std::pair<Trajectory, double>> run_get_error_tolerances(Trajectory const& trajectory) const;
+
+        /**
+         * Simplifies every trajectory of a batch concurrently on the shared work-stealing pool.
+         * Trajectories are submitted in order of decreasing estimated cost, which is quadratic in their size, so the
+         * longest trajectories start first and the short ones fill up the workers at the end of the batch.
+         * @param trajectories The trajectories to be simplified.
+         * @return The simplifications of every trajectory and the time they took, in the same order as the input.
+         */
+        [[nodiscard]] std::vector<Timed_Simplification> simplify_all(std::span<Trajectory const> trajectories) const;
+
+        /**
+         * Calculates the error tolerances of every resolution level of the trajectory, without simplifying it.
+         * @param trajectory The trajectory to be simplified.
+         * @return The error tolerances in increasing order.
+         */
+        [[nodiscard]] std::vector<double> error_tolerances(Trajectory const& trajectory) const;
+
+        /**
+         * Simplifies the original trajectory at a single error tolerance, which need not be one of the resolution
+         * levels. The high error tolerance used to skip ahead is the error tolerance scaled by the resolution scale.
+         * @param trajectory The trajectory to be simplified.
+         * @param error_tolerance The error tolerance of the simplification.
+         * @return The simplified trajectory.
+         */
+        [[nodiscard]] Trajectory simplify_at(Trajectory const& trajectory, double error_tolerance) const;
+
+        /**
+         * Simplifies the trajectory once per given error tolerance according to the mode, without removing levels of
+         * equal size. This allows error tolerances calculated on a larger trajectory to be applied to a part of it.
+         * @param trajectory The trajectory to be simplified.
+         * @param error_tolerances Increasing error tolerances.
+         * @return One simplified trajectory per error tolerance, in the same order.
+         */
+        [[nodiscard]] std::vector<Trajectory> simplify_with_tolerances(Trajectory const& trajectory,
+                                                                       std::vector<double> const& error_tolerances) const;
     };
 
+    /**
+     * MRPA with the synchronized Euclidean distance, as described in the MRPA paper.
+     */
+    using MRPA = Basic_MRPA<SED_Oracle>;
+
+    /**
+     * MRPA with the perpendicular Euclidean distance, which ignores time and is cheaper to evaluate.
+     */
+    using PED_MRPA = Basic_MRPA<PED_Oracle>;
+
+    /**
+     * MRPA with the direction-aware distance, which preserves the heading of the trajectory.
+     */
+    using DAD_MRPA = Basic_MRPA<DAD_Oracle>;
+
+    extern template class Basic_MRPA<SED_Oracle>;
+    extern template class Basic_MRPA<PED_Oracle>;
+    extern template class Basic_MRPA<DAD_Oracle>;
+
 } // simp_algorithms
 
 #endif //TRACE_Q_MRPA_HPP
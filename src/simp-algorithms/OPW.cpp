@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include "OPW.hpp"
+#include "Simplification_Levels.hpp"
+
+namespace simp_algorithms {
+
+    OPW::OPW(double resolution_scale, size_t max_window_size)
+            : resolution_scale{resolution_scale}, max_window_size{max_window_size} {
+        if (max_window_size < 3) {
+            throw std::invalid_argument("max_window_size must be at least 3");
+        }
+    }
+
+    std::vector<data_structures::Trajectory> OPW::operator()(Trajectory const& trajectory) const {
+        std::vector<Trajectory> result{};
+        if (trajectory.size() <= 2 || resolution_scale <= 1) {
+            return result;
+        }
+
+        double largest_error_tolerance{};
+        for (size_t i = 1; i + 1 < trajectory.size(); ++i) {
+            largest_error_tolerance = std::max(largest_error_tolerance, Simplification_Levels::synchronized_distance(
+                    trajectory.locations.front(), trajectory[i], trajectory.locations.back()));
+        }
+
+        auto number_of_levels = static_cast<int>(std::floor(std::log(trajectory.size()) / std::log(resolution_scale)));
+        for (int level = 0; level < number_of_levels; ++level) {
+            auto error_tolerance = largest_error_tolerance / std::pow(resolution_scale, number_of_levels - 1 - level);
+            auto simplification = simplify_at(trajectory, error_tolerance);
+            auto previous_size = result.empty() ? trajectory.size() : result.back().size();
+            if (simplification.size() < previous_size) {
+                result.emplace_back(std::move(simplification));
+            }
+        }
+        return result;
+    }
+
+    std::string OPW::description() const {
+        std::stringstream result{};
+        result << std::setprecision(std::numeric_limits<double>::max_digits10)
+               << "opw(resolution_scale=" << resolution_scale << ",max_window_size=" << max_window_size << ")";
+        return result.str();
+    }
+
+    data_structures::Trajectory OPW::simplify_at(Trajectory const& trajectory, double error_tolerance) const {
+        std::vector<size_t> kept{};
+        if (trajectory.size() <= 2) {
+            for (size_t i = 0; i < trajectory.size(); ++i) {
+                kept.push_back(i);
+            }
+            return Simplification_Levels::select(trajectory, kept);
+        }
+
+        kept.push_back(0);
+        size_t anchor = 0;
+        size_t end = 2;
+        while (end < trajectory.size()) {
+            bool fits = end - anchor < max_window_size;
+            for (auto i = anchor + 1; fits && i < end; ++i) {
+                fits = Simplification_Levels::synchronized_distance(trajectory[anchor], trajectory[i],
+                                                                    trajectory[end]) <= error_tolerance;
+            }
+
+            if (fits) {
+                end++;
+            }
+            else {
+                anchor = end - 1;
+                kept.push_back(anchor);
+                end = anchor + 2;
+            }
+        }
+        kept.push_back(trajectory.size() - 1);
+
+        return Simplification_Levels::select(trajectory, kept);
+    }
+
+} // simp_algorithms
@@ -0,0 +1,65 @@
+#ifndef TRACE_Q_OPW_HPP
+#define TRACE_Q_OPW_HPP
+
+#include <string>
+#include <vector>
+#include "../data/Trajectory.hpp"
+
+namespace simp_algorithms {
+
+    /**
+     * Opening window simplification with the synchronized Euclidean distance.
+     * Starting from an anchor, the window is extended one location at a time until a location inside it is farther
+     * than the error tolerance from the segment between the anchor and the window's end, or the window reaches its
+     * maximum size. The location before the window's end is then kept and becomes the new anchor. This only looks at
+     * the locations of a single window, so it suits streaming, and a bounded window makes each pass O(n * w).
+     * Every resolution level is a separate pass with a larger error tolerance.
+     */
+    class OPW {
+        using Trajectory = data_structures::Trajectory;
+
+        /**
+         * The factor by which the error tolerance increases between resolution levels.
+         */
+        double resolution_scale{2};
+
+        /**
+         * The maximum number of locations in a window, including the anchor.
+         */
+        size_t max_window_size{};
+
+    public:
+        OPW() : OPW(2) {};
+
+        /**
+         * @param resolution_scale The factor by which the error tolerance increases between resolution levels.
+         * @param max_window_size The maximum number of locations in a window. Must be at least 3.
+         */
+        explicit OPW(double resolution_scale, size_t max_window_size = 256);
+
+        /**
+         * Simplifies the input trajectory at every resolution level. The error tolerances increase geometrically up to
+         * the largest distance from the segment between the first and last locations, and a level is only kept if
+         * it has fewer locations than the previous one.
+         * @param trajectory The trajectory to be simplified.
+         * @return A list of simplified trajectories with decreasing resolution.
+         */
+        std::vector<Trajectory> operator()(Trajectory const& trajectory) const;
+
+        /**
+         * @return The name of the algorithm and its settings, which together identify the simplifications it produces.
+         */
+        [[nodiscard]] std::string description() const;
+
+        /**
+         * Simplifies the trajectory in a single pass at the given error tolerance.
+         * @param trajectory The trajectory to be simplified.
+         * @param error_tolerance The largest synchronized Euclidean distance a removed location may have.
+         * @return The simplified trajectory.
+         */
+        [[nodiscard]] Trajectory simplify_at(Trajectory const& trajectory, double error_tolerance) const;
+    };
+
+} // simp_algorithms
+
+#endif //TRACE_Q_OPW_HPP
@@ -0,0 +1,74 @@
+#include <stdexcept>
+#include "Online_MRPA.hpp"
+
+namespace simp_algorithms {
+
+    Online_MRPA::Online_MRPA(double error_tolerance, size_t max_window_size, double resolution_scale)
+            : mrpa{resolution_scale}, error_tolerance{error_tolerance}, max_window_size{max_window_size} {
+        if (max_window_size < 3) {
+            throw std::invalid_argument("max_window_size must be at least 3");
+        }
+        window.reserve(max_window_size);
+    }
+
+    std::vector<data_structures::Location> Online_MRPA::push(Location const& location) {
+        if (!window.empty() && location.timestamp <= window.back().timestamp) {
+            throw std::invalid_argument("Locations must arrive in increasing timestamp order");
+        }
+
+        window.push_back(location);
+        if (window.size() == 1) {
+            // The first location is always part of the simplification
+            return {number(location)};
+        }
+        if (window.size() < max_window_size) {
+            return {};
+        }
+        // Cut the trajectory at the newest location to bound the window
+        return finalize();
+    }
+
+    std::vector<data_structures::Location> Online_MRPA::finish() {
+        std::vector<Location> result{};
+        if (window.size() > 1) {
+            result = finalize();
+        }
+        window.clear();
+        finalized_count = 0;
+        return result;
+    }
+
+    size_t Online_MRPA::undecided_size() const {
+        // The first location in the window has already been finalized
+        return window.empty() ? 0 : window.size() - 1;
+    }
+
+    std::vector<data_structures::Location> Online_MRPA::finalize() {
+        Trajectory segment{0, window};
+        for (int i = 0; i < segment.size(); ++i) {
+            segment[i].order = i + 1;
+        }
+        auto simplified = mrpa.simplify_at(segment, error_tolerance);
+
+        // The first simplified location is the last finalized one, and the last one is the newest location. The
+        // simplified locations are renumbered, so they are found in the window by their increasing timestamps.
+        std::vector<Location> result{};
+        result.reserve(simplified.size() - 1);
+        size_t position = 0;
+        for (int i = 1; i < simplified.size(); ++i) {
+            while (window[position].timestamp != simplified[i].timestamp) {
+                position++;
+            }
+            result.push_back(number(window[position]));
+        }
+
+        window.erase(window.begin(), window.end() - 1);
+        return result;
+    }
+
+    data_structures::Location Online_MRPA::number(Location location) {
+        location.order = ++finalized_count;
+        return location;
+    }
+
+} // simp_algorithms
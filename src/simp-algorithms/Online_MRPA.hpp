@@ -0,0 +1,92 @@
+#ifndef TRACE_Q_ONLINE_MRPA_HPP
+#define TRACE_Q_ONLINE_MRPA_HPP
+
+#include <vector>
+#include "../data/Trajectory.hpp"
+#include "MRPA.hpp"
+
+namespace simp_algorithms {
+
+    /**
+     * Simplifies an append-only trajectory one location at a time with MRPA at a fixed error tolerance.
+     * Locations are buffered in a window that starts at the last finalized location. A trajectory that never fills the
+     * window is simplified exactly like MRPA::simplify_at simplifies it offline. Once the window is full, it is cut
+     * at its newest location: the window is simplified with both of its ends kept, every simplified location is
+     * finalized, and the cut location starts the next window. Finalized locations therefore never change.
+     * The output is the offline simplification of consecutive segments of max_window_size locations that share
+     * their end locations, so every pair of consecutive output locations still complies with the error tolerance.
+     * The cuts keep at most (n - 2) / (max_window_size - 1) locations of a trajectory of n locations that the
+     * offline simplification might drop, in exchange for memory and an amortized cost per location that are
+     * bounded by the window size rather than the length of the trajectory.
+     */
+    class Online_MRPA {
+        using Trajectory = data_structures::Trajectory;
+        using Location = data_structures::Location;
+
+        /**
+         * The MRPA instance whose resolution scale determines the high error tolerance.
+         */
+        MRPA mrpa{};
+
+        /**
+         * The error tolerance every window is simplified with.
+         */
+        double error_tolerance{};
+
+        /**
+         * The maximum number of locations in the window, including the last finalized location.
+         */
+        size_t max_window_size{};
+
+        /**
+         * The last finalized location, followed by the undecided locations.
+         */
+        std::vector<Location> window{};
+
+        /**
+         * The number of locations that have been finalized so far, which is used to number them.
+         */
+        int finalized_count{};
+
+        /**
+         * Simplifies the whole window and finalizes every simplified location except the first, which has already
+         * been finalized. The newest location is then the only location left in the window.
+         * @return The newly finalized locations.
+         */
+        std::vector<Location> finalize();
+
+        /**
+         * Marks a location as finalized by numbering it according to its position in the simplified trajectory.
+         */
+        Location number(Location location);
+
+    public:
+        /**
+         * @param error_tolerance The error tolerance the locations are simplified with.
+         * @param max_window_size The maximum number of buffered locations. Must be at least 3.
+         * @param resolution_scale The MRPA resolution scale, which scales the high error tolerance.
+         */
+        explicit Online_MRPA(double error_tolerance, size_t max_window_size = 256, double resolution_scale = 2);
+
+        /**
+         * Appends a location to the trajectory. Locations must arrive in increasing timestamp order.
+         * @param location The new location. Its order is ignored.
+         * @return The locations that were finalized by this location, in trajectory order.
+         */
+        std::vector<Location> push(Location const& location);
+
+        /**
+         * Ends the trajectory and finalizes every undecided location.
+         * @return The remaining simplified locations, in trajectory order.
+         */
+        std::vector<Location> finish();
+
+        /**
+         * @return The number of locations that are buffered but not yet finalized.
+         */
+        [[nodiscard]] size_t undecided_size() const;
+    };
+
+} // simp_algorithms
+
+#endif //TRACE_Q_ONLINE_MRPA_HPP
@@ -0,0 +1,97 @@
+#include "PED_Oracle.hpp"
+
+namespace simp_algorithms {
+
+    PED_Oracle::PED_Oracle(Trajectory const& trajectory) : trajectory{trajectory} {
+        prefix_sums.reserve(trajectory.size() + 1);
+        prefix_sums.emplace_back();
+
+        if (trajectory.size() == 0) {
+            return;
+        }
+
+        auto const& origin = trajectory[0];
+        for (auto const& location : trajectory.locations) {
+            auto x = static_cast<long double>(location.longitude) - origin.longitude;
+            auto y = static_cast<long double>(location.latitude) - origin.latitude;
+
+            auto sums = prefix_sums.back();
+            sums.x += x;
+            sums.y += y;
+            sums.xx += x * x;
+            sums.yy += y * y;
+            sums.xy += x * y;
+            prefix_sums.push_back(sums);
+        }
+    }
+
+    double PED_Oracle::operator()(int i, int j) const {
+        auto interior_points = j - i - 1;
+        if (interior_points <= 0) {
+            return 0;
+        }
+        if (interior_points <= direct_sum_limit) {
+            return direct_sum(trajectory, i, j);
+        }
+
+        // The interior points have index i to j - 2, so their sums are prefix_sums[j - 1] - prefix_sums[i].
+        auto const& low = prefix_sums[i];
+        auto const& high = prefix_sums[j - 1];
+        auto const& origin = trajectory[0];
+        auto const& start = trajectory[i - 1];
+        auto const& end = trajectory[j - 1];
+
+        auto m = static_cast<long double>(interior_points);
+        auto start_x = static_cast<long double>(start.longitude) - origin.longitude;
+        auto start_y = static_cast<long double>(start.latitude) - origin.latitude;
+        auto sum_x = high.x - low.x;
+        auto sum_y = high.y - low.y;
+
+        // Sums of (x_k - x_i)^2, (y_k - y_i)^2 and (x_k - x_i)(y_k - y_i)
+        auto sum_dx_squared = (high.xx - low.xx) - 2 * start_x * sum_x + m * start_x * start_x;
+        auto sum_dy_squared = (high.yy - low.yy) - 2 * start_y * sum_y + m * start_y * start_y;
+        auto sum_dx_dy = (high.xy - low.xy) - start_x * sum_y - start_y * sum_x + m * start_x * start_y;
+
+        auto delta_x = static_cast<long double>(end.longitude) - start.longitude;
+        auto delta_y = static_cast<long double>(end.latitude) - start.latitude;
+        auto length_squared = delta_x * delta_x + delta_y * delta_y;
+
+        long double error{};
+        if (length_squared == 0) {
+            error = sum_dx_squared + sum_dy_squared;
+        }
+        else {
+            // The squared cross product of (p_k - p_i) and the unit direction of the segment
+            error = (sum_dx_squared * delta_y * delta_y + sum_dy_squared * delta_x * delta_x
+                    - 2 * sum_dx_dy * delta_x * delta_y) / length_squared;
+        }
+
+        // Cancellation may leave a tiny negative residue where the true sum is zero.
+        return error > 0 ? static_cast<double>(error) : 0;
+    }
+
+    double PED_Oracle::direct_sum(Trajectory const& trajectory, int i, int j) {
+        // Here we subtract one from both i and j, due to 0-indexing
+        i = i - 1;
+        j = j - 1;
+        auto delta_x = trajectory[j].longitude - trajectory[i].longitude;
+        auto delta_y = trajectory[j].latitude - trajectory[i].latitude;
+        auto length_squared = delta_x * delta_x + delta_y * delta_y;
+
+        double res{};
+        for (int k = i + 1; k < j; ++k) {
+            auto x = trajectory[k].longitude - trajectory[i].longitude;
+            auto y = trajectory[k].latitude - trajectory[i].latitude;
+            if (length_squared == 0) {
+                res += x * x + y * y;
+            }
+            else {
+                auto cross = x * delta_y - y * delta_x;
+                res += cross * cross / length_squared;
+            }
+        }
+
+        return res;
+    }
+
+} // simp_algorithms
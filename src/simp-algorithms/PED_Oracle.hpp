@@ -0,0 +1,79 @@
+#ifndef TRACE_Q_PED_ORACLE_HPP
+#define TRACE_Q_PED_ORACLE_HPP
+
+#include <string_view>
+#include <vector>
+#include "../data/Trajectory.hpp"
+
+namespace simp_algorithms {
+
+    /**
+     * Answers squared perpendicular Euclidean distance (PED) sum queries over sub-ranges of a single trajectory in
+     * constant time.
+     * The PED of a point is its distance to the line through the start and end of the segment approximating it, so
+     * unlike SED it ignores time. The oracle precomputes prefix sums of the coordinates and their products, centered
+     * on the first location, and short segments are summed directly.
+     */
+    class PED_Oracle {
+        using Trajectory = data_structures::Trajectory;
+
+        /**
+         * Cumulative sums over the locations preceding a given index.
+         */
+        struct Prefix_Sums {
+            long double x{};
+            long double y{};
+            long double xx{};
+            long double yy{};
+            long double xy{};
+        };
+
+        /**
+         * Segments with at most this many interior points are summed directly.
+         */
+        static constexpr int direct_sum_limit{8};
+
+        /**
+         * The trajectory the oracle answers queries for. It must outlive the oracle.
+         */
+        Trajectory const& trajectory;
+
+        /**
+         * prefix_sums[k] holds the sums over the locations with index 0 to k - 1.
+         */
+        std::vector<Prefix_Sums> prefix_sums{};
+
+    public:
+        /**
+         * The name of the metric, which identifies it in the description of MRPA.
+         */
+        static constexpr std::string_view name{"ped"};
+
+        /**
+         * Precomputes the prefix sums for the given trajectory in a single pass.
+         * @param trajectory The trajectory that queries will be answered for.
+         */
+        explicit PED_Oracle(Trajectory const& trajectory);
+
+        /**
+         * Calculates the sum of squared PED errors over a range of the trajectory.
+         * @param i Start of the range (point order, 1-indexed).
+         * @param j End of the range (point order, 1-indexed).
+         * @return The squared PED error sum of the points strictly between i and j.
+         */
+        [[nodiscard]] double operator()(int i, int j) const;
+
+        /**
+         * Reference implementation that sums the squared distance of every point strictly between i and j to the
+         * line through i and j. If i and j coincide, the distance to that location is used instead.
+         * @param trajectory The input trajectory.
+         * @param i Start of the range (point order, 1-indexed).
+         * @param j End of the range (point order, 1-indexed).
+         * @return The squared PED error sum of the points strictly between i and j.
+         */
+        static double direct_sum(Trajectory const& trajectory, int i, int j);
+    };
+
+} // simp_algorithms
+
+#endif //TRACE_Q_PED_ORACLE_HPP
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <stdexcept>
+#include "Run_Metrics.hpp"
+
+namespace trace_q {
+
+    namespace {
+        constexpr auto relaxed = std::memory_order_relaxed;
+
+        double to_seconds(Run_Metrics::Clock::rep ticks) {
+            return std::chrono::duration<double>(Run_Metrics::Clock::duration{ticks}).count();
+        }
+
+        void store_max(std::atomic<Run_Metrics::Clock::rep>& max, Run_Metrics::Clock::rep value) {
+            auto previous = max.load(relaxed);
+            while (previous < value && !max.compare_exchange_weak(previous, value, relaxed)) {}
+        }
+    }
+
+    Run_Metrics& Run_Metrics::shared() {
+        static Run_Metrics metrics{};
+        return metrics;
+    }
+
+    std::string_view Run_Metrics::stage_name(Stage stage) {
+        switch (stage) {
+            case Stage::candidate_generation:
+                return "candidate_generation";
+            case Stage::query_initialization:
+                return "query_initialization";
+            case Stage::query_evaluation:
+                return "query_evaluation";
+            case Stage::load:
+                return "load";
+            case Stage::insert:
+                return "insert";
+            default:
+                throw std::invalid_argument("Error in switch statement in stage_name");
+        }
+    }
+
+    void Run_Metrics::start(size_t trajectory_count) {
+        trajectories.store(trajectory_count, relaxed);
+        trajectories_simplified.store(0, relaxed);
+        trajectories_kept.store(0, relaxed);
+        for (auto& stage : stages) {
+            stage.total.store(0, relaxed);
+            stage.max.store(0, relaxed);
+        }
+        query_objects_generated.store(0, relaxed);
+        query_tests_evaluated.store(0, relaxed);
+        query_tests_updated.store(0, relaxed);
+        levels_tried.store(0, relaxed);
+        for (auto& count : chosen_levels) {
+            count.store(0, relaxed);
+        }
+        started.store(Clock::now().time_since_epoch().count(), relaxed);
+        running.store(true, relaxed);
+    }
+
+    void Run_Metrics::finish() {
+        finished.store(Clock::now().time_since_epoch().count(), relaxed);
+        running.store(false, relaxed);
+    }
+
+    void Run_Metrics::add_stage_time(Stage stage, Clock::duration duration) {
+        auto& counters = stages[static_cast<size_t>(stage)];
+        counters.total.fetch_add(duration.count(), relaxed);
+        store_max(counters.max, duration.count());
+    }
+
+    void Run_Metrics::add_trajectory(Trajectory_Record const& record) {
+        add_stage_time(Stage::candidate_generation, record.candidate_generation);
+        add_stage_time(Stage::query_initialization, record.query_initialization);
+        add_stage_time(Stage::query_evaluation, record.query_evaluation);
+        query_objects_generated.fetch_add(record.query_objects, relaxed);
+        query_tests_evaluated.fetch_add(static_cast<uint64_t>(record.query_tests_evaluated), relaxed);
+        query_tests_updated.fetch_add(static_cast<uint64_t>(record.query_tests_updated), relaxed);
+        levels_tried.fetch_add(record.levels_tried, relaxed);
+        if (record.chosen_level) {
+            chosen_levels[std::min(*record.chosen_level, max_levels - 1)].fetch_add(1, relaxed);
+        }
+        else {
+            trajectories_kept.fetch_add(1, relaxed);
+        }
+        trajectories_simplified.fetch_add(1, relaxed);
+    }
+
+    Run_Metrics::Snapshot Run_Metrics::snapshot() const {
+        Snapshot result{};
+        result.running = running.load(relaxed);
+        auto start = started.load(relaxed);
+        if (start != 0) {
+            auto end = result.running ? Clock::now().time_since_epoch().count() : finished.load(relaxed);
+            result.elapsed_seconds = to_seconds(std::max(end - start, Clock::rep{0}));
+        }
+        result.trajectories = trajectories.load(relaxed);
+        result.trajectories_simplified = trajectories_simplified.load(relaxed);
+        result.trajectories_kept = trajectories_kept.load(relaxed);
+
+        for (size_t i = 0; i < stage_count; ++i) {
+            auto total = to_seconds(stages[i].total.load(relaxed));
+            result.stages[i] = {total,
+                                result.trajectories_simplified == 0
+                                        ? 0 : total / static_cast<double>(result.trajectories_simplified),
+                                to_seconds(stages[i].max.load(relaxed))};
+        }
+
+        result.query_objects_generated = query_objects_generated.load(relaxed);
+        result.query_tests_evaluated = query_tests_evaluated.load(relaxed);
+        result.query_tests_updated = query_tests_updated.load(relaxed);
+        result.levels_tried = levels_tried.load(relaxed);
+
+        for (auto const& count : chosen_levels) {
+            result.chosen_levels.push_back(count.load(relaxed));
+        }
+        while (!result.chosen_levels.empty() && result.chosen_levels.back() == 0) {
+            result.chosen_levels.pop_back();
+        }
+        return result;
+    }
+
+} // trace_q
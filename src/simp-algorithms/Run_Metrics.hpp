@@ -0,0 +1,151 @@
+#ifndef TRACE_Q_RUN_METRICS_HPP
+#define TRACE_Q_RUN_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace trace_q {
+
+    /**
+     * Where the time of a TRACE_Q run goes, recorded with relaxed atomic counters so that the simplification workers
+     * never wait on each other or on a reader. The counters can be read while the run is in progress, in which case a
+     * snapshot may mix counters from slightly different moments.
+     * The metrics describe the latest run that was started. The API performs one run at a time, since concurrent runs
+     * would reset each other's counters.
+     */
+    class Run_Metrics {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        enum class Stage {
+            /**
+             * Producing the candidate simplifications, such as the MRPA levels.
+             */
+            candidate_generation,
+            query_initialization,
+            query_evaluation,
+            load,
+            insert
+        };
+
+        static constexpr size_t stage_count{5};
+
+        /**
+         * The number of levels whose choice is counted separately. Higher levels are counted as the highest of them.
+         */
+        static constexpr size_t max_levels{64};
+
+        /**
+         * What the simplification of a single trajectory took.
+         */
+        struct Trajectory_Record {
+            Clock::duration candidate_generation{};
+            Clock::duration query_initialization{};
+            Clock::duration query_evaluation{};
+            size_t query_objects{};
+            long query_tests_evaluated{};
+
+            /**
+             * The number of query tests re-checked when moving from one candidate to the next incrementally.
+             */
+            long query_tests_updated{};
+            size_t levels_tried{};
+
+            /**
+             * The index of the accepted candidate, or nothing if the original trajectory was kept.
+             */
+            std::optional<size_t> chosen_level{};
+        };
+
+        struct Stage_Snapshot {
+            double total_seconds{};
+
+            /**
+             * The total divided by the number of trajectories simplified so far.
+             */
+            double mean_seconds_per_trajectory{};
+
+            /**
+             * The longest time of a single trajectory, or of a single batch for loading and inserting.
+             */
+            double max_seconds{};
+        };
+
+        struct Snapshot {
+            bool running{};
+            double elapsed_seconds{};
+            size_t trajectories{};
+            size_t trajectories_simplified{};
+
+            /**
+             * The number of trajectories for which no candidate was accepted, so the original was kept.
+             */
+            size_t trajectories_kept{};
+            std::array<Stage_Snapshot, stage_count> stages{};
+            uint64_t query_objects_generated{};
+            uint64_t query_tests_evaluated{};
+            uint64_t query_tests_updated{};
+            uint64_t levels_tried{};
+
+            /**
+             * The number of trajectories for which each level was chosen, up to the highest level chosen so far.
+             */
+            std::vector<uint64_t> chosen_levels{};
+        };
+
+        /**
+         * The metrics shared by all TRACE_Q runs.
+         */
+        static Run_Metrics& shared();
+
+        static std::string_view stage_name(Stage stage);
+
+        /**
+         * Resets the counters for a new run.
+         * @param trajectories The number of trajectories the run will simplify.
+         */
+        void start(size_t trajectories);
+
+        void finish();
+
+        /**
+         * Adds the time of a single trajectory or batch to a stage.
+         */
+        void add_stage_time(Stage stage, Clock::duration duration);
+
+        /**
+         * Adds a simplified trajectory, along with the time of its candidate generation, query initialization and
+         * query evaluation.
+         */
+        void add_trajectory(Trajectory_Record const& record);
+
+        [[nodiscard]] Snapshot snapshot() const;
+
+    private:
+        struct Stage_Counters {
+            std::atomic<Clock::rep> total{0};
+            std::atomic<Clock::rep> max{0};
+        };
+
+        std::atomic<bool> running{false};
+        std::atomic<Clock::rep> started{0};
+        std::atomic<Clock::rep> finished{0};
+        std::atomic<size_t> trajectories{0};
+        std::atomic<size_t> trajectories_simplified{0};
+        std::atomic<size_t> trajectories_kept{0};
+        std::array<Stage_Counters, stage_count> stages{};
+        std::atomic<uint64_t> query_objects_generated{0};
+        std::atomic<uint64_t> query_tests_evaluated{0};
+        std::atomic<uint64_t> query_tests_updated{0};
+        std::atomic<uint64_t> levels_tried{0};
+        std::array<std::atomic<uint64_t>, max_levels> chosen_levels{};
+    };
+
+} // trace_q
+
+#endif //TRACE_Q_RUN_METRICS_HPP
@@ -0,0 +1,134 @@
+#include <cmath>
+#include <limits>
+#include "SED_Oracle.hpp"
+
+namespace simp_algorithms {
+
+    namespace {
+        /**
+         * Sums the squared SED errors of the points strictly between i and j directly from the columns of the
+         * trajectory, without materializing the approximated positions.
+         */
+        double column_sum(data_structures::Trajectory_Columns const& columns, int i, int j) {
+            // Here we subtract one from both i and j, due to 0-indexing
+            i = i - 1;
+            j = j - 1;
+            auto start_time = columns.time[i];
+            auto duration = columns.time[j] - start_time;
+            auto start_longitude = columns.longitude[i];
+            auto start_latitude = columns.latitude[i];
+            auto delta_longitude = columns.longitude[j] - start_longitude;
+            auto delta_latitude = columns.latitude[j] - start_latitude;
+
+            double sum{};
+            for (int k = i + 1; k < j; ++k) {
+                auto ratio = (columns.time[k] - start_time) / duration;
+                auto error_x = columns.longitude[k] - (start_longitude + ratio * delta_longitude);
+                auto error_y = columns.latitude[k] - (start_latitude + ratio * delta_latitude);
+                sum += error_x * error_x + error_y * error_y;
+            }
+            return sum;
+        }
+    }
+
+    SED_Oracle::SED_Oracle(Trajectory const& trajectory) : trajectory{trajectory}, columns{trajectory} {
+        prefix_sums.reserve(trajectory.size() + 1);
+        prefix_sums.emplace_back();
+
+        if (trajectory.size() == 0) {
+            return;
+        }
+
+        auto const& origin = trajectory[0];
+        for (auto const& location : trajectory.locations) {
+            auto t = static_cast<std::uint64_t>(location.timestamp - origin.timestamp);
+            auto x = static_cast<long double>(location.longitude) - origin.longitude;
+            auto y = static_cast<long double>(location.latitude) - origin.latitude;
+
+            auto sums = prefix_sums.back();
+            sums.t += t;
+            sums.tt += t * t;
+            sums.x.add(x);
+            sums.y.add(y);
+            sums.xx.add(x * x);
+            sums.yy.add(y * y);
+            sums.xt.add(x * static_cast<long double>(t));
+            sums.yt.add(y * static_cast<long double>(t));
+            prefix_sums.push_back(sums);
+        }
+    }
+
+    double SED_Oracle::operator()(int i, int j) const {
+        auto interior_points = j - i - 1;
+        if (interior_points <= 0) {
+            return 0;
+        }
+        if (interior_points <= direct_sum_limit) {
+            return column_sum(columns, i, j);
+        }
+
+        // Here we subtract one from both i and j, due to 0-indexing
+        auto const& start = trajectory[i - 1];
+        auto const& end = trajectory[j - 1];
+        if (end.timestamp == start.timestamp) {
+            // The direct summation divides zero by zero in this case.
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+        // The interior points have index i to j - 2, so their sums are prefix_sums[j - 1] - prefix_sums[i].
+        auto const& low = prefix_sums[i];
+        auto const& high = prefix_sums[j - 1];
+        auto const& origin = trajectory[0];
+
+        auto m = static_cast<std::uint64_t>(interior_points);
+        auto start_t = static_cast<std::uint64_t>(start.timestamp - origin.timestamp);
+        auto start_x = static_cast<long double>(start.longitude) - origin.longitude;
+        auto start_y = static_cast<long double>(start.latitude) - origin.latitude;
+
+        // Sum of (t_k - t_i)^2, exact as long as the true value fits in 64 bits.
+        auto sum_dt_squared = static_cast<long double>(
+                (high.tt - low.tt) - 2 * start_t * (high.t - low.t) + m * start_t * start_t);
+        auto sum_t = static_cast<long double>(high.t - low.t);
+        auto m_ld = static_cast<long double>(m);
+        auto start_t_ld = static_cast<long double>(start_t);
+        auto duration = static_cast<long double>(end.timestamp - start.timestamp);
+
+        auto axis_error = [&](long double sum, long double sum_squared, long double sum_cross,
+                              long double start_value, long double velocity) {
+            // Sum of (v_k - v_i)^2
+            auto sum_dv_squared = sum_squared - 2 * start_value * sum + m_ld * start_value * start_value;
+            // Sum of (v_k - v_i)(t_k - t_i)
+            auto sum_dv_dt = sum_cross - start_t_ld * sum - start_value * sum_t + m_ld * start_value * start_t_ld;
+            return sum_dv_squared - 2 * velocity * sum_dv_dt + velocity * velocity * sum_dt_squared;
+        };
+
+        auto velocity_x = (static_cast<long double>(end.longitude) - start.longitude) / duration;
+        auto velocity_y = (static_cast<long double>(end.latitude) - start.latitude) / duration;
+
+        auto error = axis_error(high.x - low.x, high.xx - low.xx, high.xt - low.xt, start_x, velocity_x)
+                + axis_error(high.y - low.y, high.yy - low.yy, high.yt - low.yt, start_y, velocity_y);
+
+        // Cancellation may leave a tiny negative residue where the true sum is zero.
+        return error > 0 ? static_cast<double>(error) : 0;
+    }
+
+    double SED_Oracle::direct_sum(Trajectory const& trajectory, int i, int j) {
+        // Here we subtract one from both i and j, due to 0-indexing
+        i = i - 1;
+        j = j - 1;
+        double res {};
+        for (int k = i + 1; k < j; ++k) {
+            auto ratio = static_cast<long double>(trajectory[k].timestamp - trajectory[i].timestamp) /
+                         static_cast<long double>(trajectory[j].timestamp - trajectory[i].timestamp);
+            auto x = static_cast<double>(trajectory[i].longitude
+                    + ratio * (trajectory[j].longitude - trajectory[i].longitude));
+            auto y = static_cast<double>(trajectory[i].latitude
+                    + ratio * (trajectory[j].latitude - trajectory[i].latitude));
+
+            res += pow(sqrt(pow(trajectory[k].longitude - x, 2) + pow(trajectory[k].latitude - y, 2)), 2);
+        }
+
+        return res;
+    }
+
+} // simp_algorithms
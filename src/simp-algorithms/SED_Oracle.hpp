@@ -0,0 +1,124 @@
+#ifndef TRACE_Q_SED_ORACLE_HPP
+#define TRACE_Q_SED_ORACLE_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "../data/Trajectory.hpp"
+#include "../data/Trajectory_Columns.hpp"
+
+namespace simp_algorithms {
+
+    /**
+     * Answers squared SED sum queries over sub-ranges of a single trajectory in constant time.
+     * The oracle precomputes prefix sums of the time, position and cross terms once, such that the sum of squared
+     * synchronized Euclidean distances between the points strictly inside (i, j) and the segment from i to j can be
+     * expanded algebraically instead of interpolating every point.
+     * Coordinates are centered on the first location to limit cancellation, and time sums are kept as exact integers.
+     * The position sums are compensated, so the closed form agrees with the direct summation up to a relative error
+     * of roughly 1e-10 whether or not long double has extended precision, and short segments are always summed
+     * directly from the columns.
+     */
+    class SED_Oracle {
+        using Trajectory = data_structures::Trajectory;
+        using Location = data_structures::Location;
+
+        /**
+         * A running sum that keeps the rounding error of every addition in a separate term (Neumaier summation).
+         * The difference of two such sums is then accurate to about twice the precision of long double, which
+         * keeps the closed form accurate where long double is no wider than double, such as on MSVC.
+         */
+        struct Compensated_Sum {
+            long double sum{};
+            long double compensation{};
+
+            void add(long double value) {
+                auto total = sum + value;
+                if (std::abs(sum) >= std::abs(value)) {
+                    compensation += (sum - total) + value;
+                }
+                else {
+                    compensation += (value - total) + sum;
+                }
+                sum = total;
+            }
+
+            friend long double operator-(Compensated_Sum const& high, Compensated_Sum const& low) {
+                return (high.sum - low.sum) + (high.compensation - low.compensation);
+            }
+        };
+
+        /**
+         * Cumulative sums over the locations preceding a given index.
+         * Time sums are unsigned integers, which makes them exact modulo 2^64, and therefore exact for every
+         * difference that fits in 64 bits.
+         */
+        struct Prefix_Sums {
+            std::uint64_t t{};
+            std::uint64_t tt{};
+            Compensated_Sum x{};
+            Compensated_Sum y{};
+            Compensated_Sum xx{};
+            Compensated_Sum yy{};
+            Compensated_Sum xt{};
+            Compensated_Sum yt{};
+        };
+
+        /**
+         * Segments with at most this many interior points are summed directly, which is more accurate than the
+         * closed form and faster up to here. The SED oracle microbenchmark puts the crossover at about 32 interior
+         * points.
+         */
+        static constexpr int direct_sum_limit{16};
+
+        /**
+         * The trajectory the oracle answers queries for. It must outlive the oracle.
+         */
+        Trajectory const& trajectory;
+
+        /**
+         * The columns of the trajectory used to sum short segments directly.
+         */
+        data_structures::Trajectory_Columns columns;
+
+        /**
+         * prefix_sums[k] holds the sums over the locations with index 0 to k - 1.
+         */
+        std::vector<Prefix_Sums> prefix_sums{};
+
+    public:
+        /**
+         * The name of the metric, which identifies it in the description of MRPA.
+         */
+        static constexpr std::string_view name{"sed"};
+
+        /**
+         * Precomputes the prefix sums for the given trajectory in a single pass.
+         * @param trajectory The trajectory that queries will be answered for.
+         */
+        explicit SED_Oracle(Trajectory const& trajectory);
+
+        /**
+         * Calculates the sum of squared SED errors over a range of the trajectory.
+         * Equivalent to direct_sum, but answered from the prefix sums without allocating.
+         * @param i Start of the range (point order, 1-indexed).
+         * @param j End of the range (point order, 1-indexed).
+         * @return The squared SED error sum of the points strictly between i and j.
+         */
+        [[nodiscard]] double operator()(int i, int j) const;
+
+        /**
+         * Reference implementation that interpolates every point strictly between i and j on the segment from
+         * i to j and sums the squared SED errors.
+         * @param trajectory The input trajectory.
+         * @param i Start of the range (point order, 1-indexed).
+         * @param j End of the range (point order, 1-indexed).
+         * @return The squared SED error sum of the points strictly between i and j.
+         */
+        static double direct_sum(Trajectory const& trajectory, int i, int j);
+    };
+
+} // simp_algorithms
+
+#endif //TRACE_Q_SED_ORACLE_HPP
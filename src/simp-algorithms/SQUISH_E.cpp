@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <queue>
+#include <sstream>
+#include <tuple>
+#include "SQUISH_E.hpp"
+#include "Simplification_Levels.hpp"
+
+namespace simp_algorithms {
+
+    std::vector<data_structures::Trajectory> SQUISH_E::operator()(Trajectory const& trajectory) const {
+        return Simplification_Levels::by_rank(trajectory, removal_steps(trajectory),
+                                              Simplification_Levels::sizes(trajectory.size(), resolution_scale));
+    }
+
+    std::string SQUISH_E::description() const {
+        std::stringstream result{};
+        result << std::setprecision(std::numeric_limits<double>::max_digits10)
+               << "squish_e(resolution_scale=" << resolution_scale << ")";
+        return result.str();
+    }
+
+    std::vector<double> SQUISH_E::removal_steps(Trajectory const& trajectory) {
+        constexpr auto infinity = std::numeric_limits<double>::infinity();
+        auto size = trajectory.size();
+        std::vector<double> result(size, infinity);
+        if (size <= 2) {
+            return result;
+        }
+
+        // The remaining locations form a doubly linked list
+        std::vector<size_t> previous(size);
+        std::vector<size_t> next(size);
+        for (size_t i = 0; i < size; ++i) {
+            previous[i] = i - 1;
+            next[i] = i + 1;
+        }
+        std::vector<double> inherited(size, 0);
+        std::vector<double> priorities(size, infinity);
+        std::vector<unsigned int> versions(size, 0);
+
+        // Entries hold a priority, a location and the version of the location's priority when it was queued.
+        // Entries of outdated versions are skipped instead of being removed from the queue.
+        using Entry = std::tuple<double, size_t, unsigned int>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue{};
+        auto update_priority = [&](size_t i) {
+            priorities[i] = inherited[i] + Simplification_Levels::synchronized_distance(
+                    trajectory[previous[i]], trajectory[i], trajectory[next[i]]);
+            queue.emplace(priorities[i], i, ++versions[i]);
+        };
+        for (size_t i = 1; i + 1 < size; ++i) {
+            update_priority(i);
+        }
+
+        double step = 0;
+        while (!queue.empty()) {
+            auto [priority, i, version] = queue.top();
+            queue.pop();
+            if (version != versions[i] || result[i] != infinity) {
+                continue;
+            }
+
+            result[i] = step++;
+            auto before = previous[i];
+            auto after = next[i];
+            next[before] = after;
+            previous[after] = before;
+            for (auto neighbour : {before, after}) {
+                if (neighbour != 0 && neighbour != size - 1) {
+                    inherited[neighbour] = std::max(inherited[neighbour], priority);
+                    update_priority(neighbour);
+                }
+            }
+        }
+
+        return result;
+    }
+
+} // simp_algorithms
@@ -0,0 +1,53 @@
+#ifndef TRACE_Q_SQUISH_E_HPP
+#define TRACE_Q_SQUISH_E_HPP
+
+#include <string>
+#include <vector>
+#include "../data/Trajectory.hpp"
+
+namespace simp_algorithms {
+
+    /**
+     * SQUISH-E, a bottom-up simplification that repeatedly removes the location of lowest priority.
+     * The priority of a location is its synchronized Euclidean distance to the segment between its neighbours, plus
+     * the largest priority of the removed locations it has inherited. When a location is removed, its neighbours
+     * inherit its priority, so the priority bounds the error the location's removal would cause. Removing every
+     * interior location once records the removal order, from which all resolution levels are derived in
+     * O(n log n) time.
+     */
+    class SQUISH_E {
+        using Trajectory = data_structures::Trajectory;
+
+        /**
+         * The factor by which the number of locations decreases between resolution levels.
+         */
+        double resolution_scale{2};
+
+    public:
+        SQUISH_E() = default;
+        explicit SQUISH_E(double resolution_scale) : resolution_scale{resolution_scale} {};
+
+        /**
+         * Simplifies the input trajectory at every resolution level.
+         * @param trajectory The trajectory to be simplified.
+         * @return A list of simplified trajectories with decreasing resolution.
+         */
+        std::vector<Trajectory> operator()(Trajectory const& trajectory) const;
+
+        /**
+         * @return The name of the algorithm and its settings, which together identify the simplifications it produces.
+         */
+        [[nodiscard]] std::string description() const;
+
+        /**
+         * Calculates the step at which every location is removed. The first and last locations are never removed
+         * and have an infinite removal step.
+         * @param trajectory The trajectory to be simplified.
+         * @return The removal step of every location, in trajectory order.
+         */
+        static std::vector<double> removal_steps(Trajectory const& trajectory);
+    };
+
+} // simp_algorithms
+
+#endif //TRACE_Q_SQUISH_E_HPP
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <future>
+#include "Segmented_MRPA.hpp"
+#include "../concurrency/Work_Stealing_Pool.hpp"
+
+namespace simp_algorithms {
+
+    Segmented_MRPA::Segmented_MRPA(double resolution_scale, size_t memory_ceiling)
+            // The segments already run on the shared work-stealing pool, so their levels are computed in sequence
+            : mrpa{resolution_scale, MRPA::Mode::cascading},
+              segment_size{std::max(memory_ceiling / bytes_per_location, min_segment_size)} {}
+
+    std::vector<data_structures::Trajectory> Segmented_MRPA::operator()(Trajectory const& trajectory) const {
+        if (trajectory.size() <= segment_size) {
+            return mrpa(trajectory);
+        }
+
+        auto error_tolerances = mrpa.error_tolerances(trajectory);
+        auto segments = split(trajectory);
+
+        auto& pool = concurrency::Work_Stealing_Pool::shared();
+        std::vector<std::future<std::vector<Trajectory>>> futures{};
+        futures.reserve(segments.size());
+        for (auto const& segment : segments) {
+            futures.emplace_back(pool.submit([this, &segment, &error_tolerances]() {
+                return mrpa.simplify_with_tolerances(segment, error_tolerances);
+            }));
+        }
+
+        // The tasks refer to the segments, so all of them must finish before an exception leaves this scope
+        for (auto& future : futures) {
+            pool.wait(future);
+        }
+        // simplified_segments[s][l] is level l of segment s
+        std::vector<std::vector<Trajectory>> simplified_segments{};
+        simplified_segments.reserve(segments.size());
+        for (auto& future : futures) {
+            simplified_segments.emplace_back(future.get());
+        }
+
+        std::vector<Trajectory> result{};
+        result.reserve(error_tolerances.size());
+        std::vector<Trajectory const*> level_segments(segments.size());
+        for (int level = 0; level < error_tolerances.size(); ++level) {
+            for (int s = 0; s < simplified_segments.size(); ++s) {
+                level_segments[s] = &simplified_segments[s][level];
+            }
+            result.emplace_back(stitch(trajectory.id, level_segments));
+        }
+
+        // Remove duplicates that may occur with very small resolution scales
+        for (auto i = static_cast<int>(result.size() - 1); i > 0; i--) {
+            if (result[i].size() == result[i - 1].size()) {
+                result.erase(std::begin(result) + i);
+            }
+        }
+
+        return result;
+    }
+
+    std::vector<data_structures::Trajectory> Segmented_MRPA::split(Trajectory const& trajectory) const {
+        std::vector<Trajectory> result{};
+
+        size_t start = 0;
+        while (start + 1 < trajectory.size()) {
+            auto end = std::min(start + segment_size - 1, trajectory.size() - 1);
+            // A short tail is merged into the last segment, rather than becoming a segment of its own
+            if (trajectory.size() - 1 - end < segment_size / 2) {
+                end = trajectory.size() - 1;
+            }
+
+            Trajectory segment{trajectory.id, {trajectory.locations.begin() + static_cast<std::ptrdiff_t>(start),
+                                               trajectory.locations.begin() + static_cast<std::ptrdiff_t>(end) + 1}};
+            for (int i = 0; i < segment.size(); ++i) {
+                segment[i].order = i + 1;
+            }
+            result.emplace_back(std::move(segment));
+            start = end;
+        }
+
+        return result;
+    }
+
+    data_structures::Trajectory Segmented_MRPA::stitch(unsigned id, std::vector<Trajectory const*> const& segments) {
+        Trajectory result{id, {}};
+        for (auto const* segment : segments) {
+            // Every segment after the first starts with the last location of its predecessor
+            auto first = result.locations.empty() ? segment->locations.begin() : segment->locations.begin() + 1;
+            result.locations.insert(result.locations.end(), first, segment->locations.end());
+        }
+
+        for (int i = 0; i < result.size(); ++i) {
+            result[i].order = i + 1;
+        }
+        return result;
+    }
+
+} // simp_algorithms
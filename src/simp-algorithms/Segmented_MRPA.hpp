@@ -0,0 +1,81 @@
+#ifndef TRACE_Q_SEGMENTED_MRPA_HPP
+#define TRACE_Q_SEGMENTED_MRPA_HPP
+
+#include <vector>
+#include "../data/Trajectory.hpp"
+#include "MRPA.hpp"
+
+namespace simp_algorithms {
+
+    /**
+     * Simplifies very long trajectories with MRPA in segments of bounded size.
+     * The error tolerances are calculated once for the whole trajectory. The trajectory is then split into segments
+     * that share their first and last locations with their neighbours, every segment is simplified at each of the
+     * error tolerances concurrently, and the segments of each level are stitched back together at the shared anchors.
+     * Since no simplified segment can skip its anchors, a level may keep a few more locations than whole-trajectory
+     * MRPA at the same error tolerance.
+     */
+    class Segmented_MRPA {
+        using Trajectory = data_structures::Trajectory;
+
+        /**
+         * The MRPA instance used for the whole trajectory's tolerances and for every segment.
+         */
+        MRPA mrpa{};
+
+        /**
+         * The maximum number of locations per segment, derived from the memory ceiling.
+         */
+        size_t segment_size{};
+
+        /**
+         * Splits the trajectory into segments that overlap in exactly one location.
+         * @param trajectory The trajectory to split.
+         * @return The segments in trajectory order, each with orders renumbered from 1.
+         */
+        [[nodiscard]] std::vector<Trajectory> split(Trajectory const& trajectory) const;
+
+        /**
+         * Concatenates simplified segments, skipping the anchor every segment shares with its predecessor.
+         * @param id The id of the resulting trajectory.
+         * @param segments The simplified segments in trajectory order.
+         * @return The stitched trajectory with orders renumbered from 1.
+         */
+        static Trajectory stitch(unsigned id, std::vector<Trajectory const*> const& segments);
+
+    public:
+        /**
+         * Estimated upper bound on the working memory MRPA needs per location of a segment, in bytes.
+         * This covers the SED oracle, the tree, the frontier, the approximation arrays and the simplified levels.
+         */
+        static constexpr size_t bytes_per_location{512};
+
+        /**
+         * The smallest segment size that is used regardless of the memory ceiling.
+         */
+        static constexpr size_t min_segment_size{16};
+
+        /**
+         * @param resolution_scale The MRPA resolution scale.
+         * @param memory_ceiling The number of bytes a single segment may use while it is simplified.
+         */
+        Segmented_MRPA(double resolution_scale, size_t memory_ceiling);
+
+        /**
+         * Simplifies the input trajectory segment by segment.
+         * @param trajectory The trajectory to be simplified.
+         * @return A list of simplified trajectories with decreasing resolution.
+         */
+        std::vector<Trajectory> operator()(Trajectory const& trajectory) const;
+
+        /**
+         * @return The maximum number of locations per segment.
+         */
+        [[nodiscard]] size_t get_segment_size() const {
+            return segment_size;
+        }
+    };
+
+} // simp_algorithms
+
+#endif //TRACE_Q_SEGMENTED_MRPA_HPP
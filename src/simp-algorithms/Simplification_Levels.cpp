@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "Simplification_Levels.hpp"
+
+namespace simp_algorithms {
+
+    std::vector<size_t> Simplification_Levels::sizes(size_t trajectory_size, double resolution_scale) {
+        std::vector<size_t> result{};
+        if (trajectory_size <= 2 || resolution_scale <= 1) {
+            return result;
+        }
+
+        auto number_of_levels = static_cast<int>(std::floor(std::log(trajectory_size) / std::log(resolution_scale)));
+        auto size = static_cast<double>(trajectory_size);
+        for (int level = 0; level < number_of_levels; ++level) {
+            size /= resolution_scale;
+            auto level_size = std::max(static_cast<size_t>(std::round(size)), size_t{2});
+            if (result.empty() || level_size < result.back()) {
+                result.push_back(level_size);
+            }
+        }
+        return result;
+    }
+
+    std::vector<data_structures::Trajectory> Simplification_Levels::by_rank(
+            Trajectory const& trajectory, std::vector<double> const& ranks, std::vector<size_t> const& sizes) {
+        std::vector<size_t> by_decreasing_rank(trajectory.size());
+        std::iota(by_decreasing_rank.begin(), by_decreasing_rank.end(), 0);
+        std::ranges::stable_sort(by_decreasing_rank, std::greater{}, [&ranks](size_t index) { return ranks[index]; });
+
+        // The place of every location when ordered by decreasing rank
+        std::vector<size_t> places(trajectory.size());
+        for (size_t place = 0; place < by_decreasing_rank.size(); ++place) {
+            places[by_decreasing_rank[place]] = place;
+        }
+
+        std::vector<Trajectory> result{};
+        result.reserve(sizes.size());
+        std::vector<size_t> indices{};
+        for (auto size : sizes) {
+            indices.clear();
+            for (size_t i = 0; i < trajectory.size(); ++i) {
+                if (places[i] < size) {
+                    indices.push_back(i);
+                }
+            }
+            result.emplace_back(select(trajectory, indices));
+        }
+        return result;
+    }
+
+    data_structures::Trajectory Simplification_Levels::select(Trajectory const& trajectory,
+                                                              std::vector<size_t> const& indices) {
+        Trajectory result{trajectory.id, {}};
+        result.locations.reserve(indices.size());
+        for (auto index : indices) {
+            result.locations.push_back(trajectory[index]);
+            result.locations.back().order = static_cast<int>(result.locations.size());
+        }
+        return result;
+    }
+
+    double Simplification_Levels::synchronized_distance(Location const& start, Location const& location,
+                                                        Location const& end) {
+        auto duration = static_cast<double>(end.timestamp - start.timestamp);
+        auto ratio = duration == 0 ? 0 : static_cast<double>(location.timestamp - start.timestamp) / duration;
+        auto longitude = start.longitude + ratio * (end.longitude - start.longitude);
+        auto latitude = start.latitude + ratio * (end.latitude - start.latitude);
+        return std::hypot(location.longitude - longitude, location.latitude - latitude);
+    }
+
+} // simp_algorithms
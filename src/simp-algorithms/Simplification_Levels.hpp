@@ -0,0 +1,59 @@
+#ifndef TRACE_Q_SIMPLIFICATION_LEVELS_HPP
+#define TRACE_Q_SIMPLIFICATION_LEVELS_HPP
+
+#include <vector>
+#include "../data/Trajectory.hpp"
+
+namespace simp_algorithms {
+
+    /**
+     * Building blocks shared by the simplification algorithms that produce resolution levels the way MRPA does,
+     * i.e. a list of simplified trajectories with decreasing resolution.
+     */
+    class Simplification_Levels {
+        using Trajectory = data_structures::Trajectory;
+        using Location = data_structures::Location;
+
+    public:
+        /**
+         * The number of locations in every resolution level. Like MRPA, there are floor(log_c(n)) levels, where c
+         * is the resolution scale, and level k keeps about n / c^(k + 1) locations. Levels of equal size are omitted.
+         * @param trajectory_size The number of locations in the original trajectory.
+         * @param resolution_scale The factor by which the number of locations decreases between levels.
+         * @return The level sizes in decreasing order, all of which are at least 2.
+         */
+        static std::vector<size_t> sizes(size_t trajectory_size, double resolution_scale);
+
+        /**
+         * Creates one simplification per size, where a simplification of size m keeps the m locations of highest
+         * rank. The rank must be such that every simplification is a valid one for the algorithm, e.g. the removal
+         * step of a location for bottom-up algorithms.
+         * @param trajectory The original trajectory.
+         * @param ranks The rank of every location of the trajectory. The first and last locations must have the
+         * highest ranks.
+         * @param sizes The sizes of the simplifications.
+         * @return The simplifications in the order of the sizes, with orders renumbered from 1.
+         */
+        static std::vector<Trajectory> by_rank(Trajectory const& trajectory, std::vector<double> const& ranks,
+                                               std::vector<size_t> const& sizes);
+
+        /**
+         * Creates a trajectory of the locations at the given indices, with orders renumbered from 1.
+         * @param trajectory The original trajectory.
+         * @param indices Increasing 0-indexed positions in the original trajectory.
+         */
+        static Trajectory select(Trajectory const& trajectory, std::vector<size_t> const& indices);
+
+        /**
+         * The synchronized Euclidean distance of a location to the segment between two other locations, i.e. the
+         * distance to the position on the segment at the same time.
+         * @param start The start of the segment.
+         * @param location The location whose distance is measured, between start and end in time.
+         * @param end The end of the segment.
+         */
+        static double synchronized_distance(Location const& start, Location const& location, Location const& end);
+    };
+
+} // simp_algorithms
+
+#endif //TRACE_Q_SIMPLIFICATION_LEVELS_HPP
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include "Simplification_Pipeline.hpp"
+#include "../concurrency/Bounded_Queue.hpp"
+
+namespace trace_q {
+
+    namespace {
+        using Clock = std::chrono::steady_clock;
+        using Trajectory_Queue = concurrency::Bounded_Queue<data_structures::Trajectory>;
+
+        /**
+         * Waits between attempts on a full or empty queue, first by yielding and then by sleeping for increasingly
+         * long, up to a millisecond.
+         */
+        class Backoff {
+            int attempts{};
+
+        public:
+            void wait() {
+                if (attempts < 16) {
+                    std::this_thread::yield();
+                }
+                else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(10 << std::min(attempts - 16, 6)));
+                }
+                attempts++;
+            }
+
+            void reset() {
+                attempts = 0;
+            }
+        };
+
+        /**
+         * The trajectories and busy time of a stage, shared by its threads.
+         */
+        struct Stage_Counters {
+            std::atomic<size_t> trajectories{0};
+            std::atomic<Clock::rep> busy{0};
+
+            void add(size_t count, Clock::duration duration) {
+                trajectories += count;
+                busy += duration.count();
+            }
+
+            [[nodiscard]] Simplification_Pipeline::Stage_Stats stats() const {
+                return {trajectories.load(), std::chrono::duration<double>(Clock::duration{busy.load()}).count()};
+            }
+        };
+
+        /**
+         * The depth of a queue, sampled by its producers.
+         */
+        struct Depth_Samples {
+            std::atomic<size_t> max{0};
+            std::atomic<size_t> sum{0};
+            std::atomic<size_t> count{0};
+
+            void sample(size_t depth) {
+                auto previous = max.load();
+                while (previous < depth && !max.compare_exchange_weak(previous, depth)) {}
+                sum += depth;
+                count++;
+            }
+
+            [[nodiscard]] Simplification_Pipeline::Queue_Stats stats(size_t capacity) const {
+                auto samples = count.load();
+                return {capacity, max.load(),
+                        samples == 0 ? 0 : static_cast<double>(sum.load()) / static_cast<double>(samples)};
+            }
+        };
+    }
+
+    std::string Simplification_Pipeline::Stats::to_string() const {
+        std::stringstream result{};
+        result << std::fixed << std::setprecision(1)
+               << write.trajectories << " trajectories in " << seconds << " s" << "\n"
+               << "load: " << load.throughput() << " trajectories/s while busy, " << load.busy_seconds << " s busy\n"
+               << "simplify: " << simplify.throughput() << " trajectories/s while busy, " << simplify.busy_seconds
+               << " s busy\n"
+               << "write: " << write.throughput() << " trajectories/s while busy, " << write.busy_seconds << " s busy\n"
+               << "loaded queue depth: mean " << loaded.mean_depth << ", max " << loaded.max_depth << " of "
+               << loaded.capacity << "\n"
+               << "simplified queue depth: mean " << simplified.mean_depth << ", max " << simplified.max_depth
+               << " of " << simplified.capacity;
+        return result.str();
+    }
+
+    Simplification_Pipeline::Simplification_Pipeline(Load load, Simplify simplify, Write write, Options options)
+            : load{std::move(load)}, simplify{std::move(simplify)}, write{std::move(write)}, options{options} {
+        this->options.batch_size = std::max(this->options.batch_size, size_t{1});
+        this->options.workers = std::max(this->options.workers, 1u);
+    }
+
+    Simplification_Pipeline::Stats Simplification_Pipeline::run(std::vector<unsigned int> const& ids) const {
+        auto start = Clock::now();
+        Trajectory_Queue loaded{options.queue_capacity};
+        Trajectory_Queue simplified{options.queue_capacity};
+        Stage_Counters load_counters{};
+        Stage_Counters simplify_counters{};
+        Stage_Counters write_counters{};
+        Depth_Samples loaded_depth{};
+        Depth_Samples simplified_depth{};
+
+        std::atomic<bool> loading_done{false};
+        std::atomic<unsigned int> active_workers{options.workers};
+
+        // The first exception of any stage stops every stage
+        std::atomic<bool> failed{false};
+        std::exception_ptr exception{};
+        std::mutex exception_mutex{};
+        auto fail = [&]() {
+            std::scoped_lock lock{exception_mutex};
+            if (!exception) {
+                exception = std::current_exception();
+            }
+            failed = true;
+        };
+
+        auto push = [&failed](Trajectory_Queue& queue, Trajectory&& trajectory, Depth_Samples& depth) {
+            Backoff backoff{};
+            while (!queue.try_push(std::move(trajectory))) {
+                if (failed) {
+                    return false;
+                }
+                backoff.wait();
+            }
+            depth.sample(queue.size());
+            return true;
+        };
+
+        std::thread loader{[&]() {
+            try {
+                for (size_t first = 0; first < ids.size() && !failed; first += options.batch_size) {
+                    std::vector<unsigned int> batch(ids.begin() + static_cast<std::ptrdiff_t>(first),
+                                                    ids.begin() + static_cast<std::ptrdiff_t>(
+                                                            std::min(first + options.batch_size, ids.size())));
+                    auto load_start = Clock::now();
+                    auto trajectories = load(batch);
+                    load_counters.add(trajectories.size(), Clock::now() - load_start);
+
+                    for (auto& trajectory : trajectories) {
+                        if (!push(loaded, std::move(trajectory), loaded_depth)) {
+                            break;
+                        }
+                    }
+                }
+            }
+            catch (...) {
+                fail();
+            }
+            loading_done = true;
+        }};
+
+        std::vector<std::thread> workers{};
+        for (unsigned int i = 0; i < options.workers; ++i) {
+            workers.emplace_back([&]() {
+                try {
+                    Backoff backoff{};
+                    while (!failed) {
+                        // Loading must have finished before the queue was found empty for the worker to stop
+                        auto done = loading_done.load();
+                        auto trajectory = loaded.try_pop();
+                        if (!trajectory) {
+                            if (done) {
+                                break;
+                            }
+                            backoff.wait();
+                            continue;
+                        }
+                        backoff.reset();
+
+                        auto simplify_start = Clock::now();
+                        auto simplification = simplify(*trajectory);
+                        simplify_counters.add(1, Clock::now() - simplify_start);
+                        if (!push(simplified, std::move(simplification), simplified_depth)) {
+                            break;
+                        }
+                    }
+                }
+                catch (...) {
+                    fail();
+                }
+                active_workers--;
+            });
+        }
+
+        std::thread writer{[&]() {
+            try {
+                std::vector<Trajectory> batch{};
+                Backoff backoff{};
+                while (!failed) {
+                    auto done = active_workers.load() == 0;
+                    auto trajectory = simplified.try_pop();
+                    if (trajectory) {
+                        batch.push_back(std::move(*trajectory));
+                        backoff.reset();
+                        if (batch.size() < options.batch_size) {
+                            continue;
+                        }
+                    }
+                    else if (batch.empty()) {
+                        if (done) {
+                            break;
+                        }
+                        backoff.wait();
+                        continue;
+                    }
+
+                    // A full batch, or whatever is ready once the queue runs empty
+                    auto write_start = Clock::now();
+                    write(batch);
+                    write_counters.add(batch.size(), Clock::now() - write_start);
+                    batch.clear();
+                }
+            }
+            catch (...) {
+                fail();
+            }
+        }};
+
+        loader.join();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        writer.join();
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+
+        return Stats{std::chrono::duration<double>(Clock::now() - start).count(),
+                     load_counters.stats(), simplify_counters.stats(), write_counters.stats(),
+                     loaded_depth.stats(loaded.capacity()), simplified_depth.stats(simplified.capacity())};
+    }
+
+} // trace_q
@@ -0,0 +1,111 @@
+#ifndef TRACE_Q_SIMPLIFICATION_PIPELINE_HPP
+#define TRACE_Q_SIMPLIFICATION_PIPELINE_HPP
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../data/Trajectory.hpp"
+
+namespace trace_q {
+
+    /**
+     * Loads, simplifies and writes trajectories in three overlapping stages, connected by bounded lock-free queues.
+     * A loader thread prefetches the trajectories in batches, a pool of worker threads simplifies them one at a time,
+     * and a writer thread writes the simplifications in batches. A long trajectory therefore only occupies one worker
+     * while the other trajectories keep flowing past it, and the queues keep loading and writing from running ahead of
+     * or behind the simplification.
+     */
+    class Simplification_Pipeline {
+    public:
+        using Trajectory = data_structures::Trajectory;
+
+        /**
+         * Loads the trajectories with the given IDs.
+         */
+        using Load = std::function<std::vector<Trajectory>(std::vector<unsigned int> const&)>;
+
+        using Simplify = std::function<Trajectory(Trajectory const&)>;
+
+        /**
+         * Writes a batch of simplified trajectories.
+         */
+        using Write = std::function<void(std::vector<Trajectory> const&)>;
+
+        struct Options {
+            /**
+             * The number of trajectories loaded at a time, and the most that are written at a time.
+             */
+            size_t batch_size{32};
+
+            /**
+             * The capacity of each queue, in trajectories.
+             */
+            size_t queue_capacity{64};
+
+            /**
+             * The number of simplification workers. Zero is replaced by one.
+             */
+            unsigned int workers{std::thread::hardware_concurrency()};
+        };
+
+        struct Stage_Stats {
+            /**
+             * The number of trajectories that passed the stage.
+             */
+            size_t trajectories{};
+
+            /**
+             * The time the stage spent in its load, simplify or write function, summed over its threads.
+             */
+            double busy_seconds{};
+
+            /**
+             * The trajectories per second the stage processes while it is busy.
+             */
+            [[nodiscard]] double throughput() const {
+                return busy_seconds > 0 ? static_cast<double>(trajectories) / busy_seconds : 0;
+            }
+        };
+
+        struct Queue_Stats {
+            size_t capacity{};
+
+            /**
+             * The number of trajectories in the queue, sampled whenever one is added.
+             */
+            size_t max_depth{};
+            double mean_depth{};
+        };
+
+        struct Stats {
+            double seconds{};
+            Stage_Stats load{};
+            Stage_Stats simplify{};
+            Stage_Stats write{};
+            Queue_Stats loaded{};
+            Queue_Stats simplified{};
+
+            [[nodiscard]] std::string to_string() const;
+        };
+
+        Simplification_Pipeline(Load load, Simplify simplify, Write write, Options options);
+
+        /**
+         * Loads, simplifies and writes the trajectories with the given IDs, and waits until all of them are written.
+         * @param ids The IDs of the trajectories.
+         * @return The throughput of every stage and the depth of the queues.
+         * @throws The first exception thrown by a stage, once every stage has stopped.
+         */
+        Stats run(std::vector<unsigned int> const& ids) const;
+
+    private:
+        Load load;
+        Simplify simplify;
+        Write write;
+        Options options;
+    };
+
+} // trace_q
+
+#endif //TRACE_Q_SIMPLIFICATION_PIPELINE_HPP
@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <tuple>
+#include "TD_TR.hpp"
+#include "Simplification_Levels.hpp"
+
+namespace simp_algorithms {
+
+    std::vector<data_structures::Trajectory> TD_TR::operator()(Trajectory const& trajectory) const {
+        return Simplification_Levels::by_rank(trajectory, split_distances(trajectory),
+                                              Simplification_Levels::sizes(trajectory.size(), resolution_scale));
+    }
+
+    std::string TD_TR::description() const {
+        std::stringstream result{};
+        result << std::setprecision(std::numeric_limits<double>::max_digits10)
+               << "td_tr(resolution_scale=" << resolution_scale << ")";
+        return result.str();
+    }
+
+    std::vector<double> TD_TR::split_distances(Trajectory const& trajectory) {
+        constexpr auto infinity = std::numeric_limits<double>::infinity();
+        std::vector<double> result(trajectory.size(), 0);
+        if (trajectory.size() < 2) {
+            std::ranges::fill(result, infinity);
+            return result;
+        }
+        result.front() = infinity;
+        result.back() = infinity;
+
+        // Segments still to be split, along with the split distance of the split that created them
+        std::vector<std::tuple<size_t, size_t, double>> segments{{0, trajectory.size() - 1, infinity}};
+        while (!segments.empty()) {
+            auto [start, end, cap] = segments.back();
+            segments.pop_back();
+            if (end - start < 2) {
+                continue;
+            }
+
+            size_t farthest = start + 1;
+            double farthest_distance = -1;
+            for (auto i = start + 1; i < end; ++i) {
+                auto distance = Simplification_Levels::synchronized_distance(trajectory[start], trajectory[i],
+                                                                             trajectory[end]);
+                if (distance > farthest_distance) {
+                    farthest = i;
+                    farthest_distance = distance;
+                }
+            }
+
+            // A split must rank strictly below the split that created its segment, so that it is never kept alone
+            auto split_distance = farthest_distance < cap ? farthest_distance : std::nextafter(cap, -infinity);
+            result[farthest] = split_distance;
+            segments.emplace_back(start, farthest, split_distance);
+            segments.emplace_back(farthest, end, split_distance);
+        }
+
+        return result;
+    }
+
+} // simp_algorithms
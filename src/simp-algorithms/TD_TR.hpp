@@ -0,0 +1,52 @@
+#ifndef TRACE_Q_TD_TR_HPP
+#define TRACE_Q_TD_TR_HPP
+
+#include <string>
+#include <vector>
+#include "../data/Trajectory.hpp"
+
+namespace simp_algorithms {
+
+    /**
+     * Top-down time-ratio simplification, i.e. Douglas-Peucker with the synchronized Euclidean distance.
+     * The trajectory is split recursively at the location farthest from the segment between the current endpoints.
+     * The split distances are capped below the distance of the split that created the segment, so keeping the
+     * locations of highest split distance never keeps a split without the splits it depends on. All resolution levels
+     * are therefore derived from a single recursion, which takes O(n log n) time for balanced splits.
+     */
+    class TD_TR {
+        using Trajectory = data_structures::Trajectory;
+
+        /**
+         * The factor by which the number of locations decreases between resolution levels.
+         */
+        double resolution_scale{2};
+
+    public:
+        TD_TR() = default;
+        explicit TD_TR(double resolution_scale) : resolution_scale{resolution_scale} {};
+
+        /**
+         * Simplifies the input trajectory at every resolution level.
+         * @param trajectory The trajectory to be simplified.
+         * @return A list of simplified trajectories with decreasing resolution.
+         */
+        std::vector<Trajectory> operator()(Trajectory const& trajectory) const;
+
+        /**
+         * @return The name of the algorithm and its settings, which together identify the simplifications it produces.
+         */
+        [[nodiscard]] std::string description() const;
+
+        /**
+         * Calculates the capped split distance of every location. The first and last locations are never split
+         * away and have an infinite distance.
+         * @param trajectory The trajectory to be simplified.
+         * @return The split distance of every location, in trajectory order.
+         */
+        static std::vector<double> split_distances(Trajectory const& trajectory);
+    };
+
+} // simp_algorithms
+
+#endif //TRACE_Q_TD_TR_HPP
@@ -3,28 +3,108 @@
 #include <cmath>
 #include <algorithm>
 #include <limits>
+#include <iomanip>
+#include <sstream>
 #include "TRACE_Q.hpp"
 #include "MRPA.hpp"
+#include "../concurrency/Work_Stealing_Pool.hpp"
 #include "../trajectory_data_handling/Trajectory_Manager.hpp"
 
 namespace trace_q {
 
     data_structures::Trajectory TRACE_Q::simplify(data_structures::Trajectory const& original_trajectory) const {
         if (original_trajectory.size() <= 2) {
+            Run_Metrics::shared().add_trajectory({});
             return original_trajectory;
         }
 
-        auto simplifications = mrpa(original_trajectory);
+        if (use_tolerance_bisection) {
+            return simplify_by_bisection(original_trajectory);
+        }
+
+        Run_Metrics::Trajectory_Record record{};
+        auto start = Run_Metrics::Clock::now();
+        auto simplifications = candidate_generator(original_trajectory);
+        record.candidate_generation = Run_Metrics::Clock::now() - start;
 
+        start = Run_Metrics::Clock::now();
         auto query_objects = initialize_query_tests(original_trajectory);
-        // iterate from the back since simplifications appear in decreasing resolution
+        record.query_initialization = Run_Metrics::Clock::now() - start;
+        record.query_objects = query_objects.size();
+
+        start = Run_Metrics::Clock::now();
+        spatial_queries::Query_Evaluator evaluator{original_trajectory, query_objects, use_KNN_for_query_accuracy};
+        // iterate from the back since simplifications appear in decreasing resolution. Consecutive levels share most
+        // of their locations, so the evaluator only re-evaluates the tests of the locations that differ.
         for (int i = static_cast<int>(simplifications.size()) - 1; i >= 0; --i) {
-            auto query_accuracy_res = query_accuracy(simplifications[i], query_objects);
-            if (query_accuracy_res.range_f1 >= min_range_query_accuracy && query_accuracy_res.knn_f1 >= min_knn_query_accuracy) {
-                return simplifications[i];
+            record.levels_tried++;
+            if (is_accepted(simplifications[i], evaluator)) {
+                record.chosen_level = static_cast<size_t>(i);
+                break;
             }
         }
-        return original_trajectory;
+        record.query_evaluation = Run_Metrics::Clock::now() - start;
+        record.query_tests_evaluated = evaluator.evaluated_tests();
+        record.query_tests_updated = evaluator.updated_tests();
+        Run_Metrics::shared().add_trajectory(record);
+
+        return record.chosen_level ? simplifications[*record.chosen_level] : original_trajectory;
+    }
+
+    data_structures::Trajectory TRACE_Q::simplify_by_bisection(
+            data_structures::Trajectory const& original_trajectory) const {
+        Run_Metrics::Trajectory_Record record{};
+        auto start = Run_Metrics::Clock::now();
+        auto error_tolerances = mrpa.error_tolerances(original_trajectory);
+        record.candidate_generation = Run_Metrics::Clock::now() - start;
+
+        start = Run_Metrics::Clock::now();
+        auto query_objects = initialize_query_tests(original_trajectory);
+        record.query_initialization = Run_Metrics::Clock::now() - start;
+        record.query_objects = query_objects.size();
+
+        start = Run_Metrics::Clock::now();
+        spatial_queries::Query_Evaluator evaluator{original_trajectory, query_objects, use_KNN_for_query_accuracy};
+        record.query_evaluation = Run_Metrics::Clock::now() - start;
+
+        // The original trajectory is accepted below the first tolerance, and nothing is accepted past the last.
+        // Every index up to accepted is assumed to be accepted and every index from rejected to be rejected.
+        int accepted = -1;
+        auto rejected = static_cast<int>(error_tolerances.size());
+        auto result = original_trajectory;
+
+        while (rejected - accepted > 1) {
+            auto middle = accepted + (rejected - accepted) / 2;
+            start = Run_Metrics::Clock::now();
+            auto simplification = mrpa.simplify_at(original_trajectory, error_tolerances[middle]);
+            record.candidate_generation += Run_Metrics::Clock::now() - start;
+
+            start = Run_Metrics::Clock::now();
+            record.levels_tried++;
+            auto is_simplification_accepted = is_accepted(simplification, evaluator);
+            record.query_evaluation += Run_Metrics::Clock::now() - start;
+            if (is_simplification_accepted) {
+                accepted = middle;
+                result = std::move(simplification);
+            }
+            else {
+                rejected = middle;
+            }
+        }
+
+        if (accepted >= 0) {
+            record.chosen_level = static_cast<size_t>(accepted);
+        }
+        record.query_tests_evaluated = evaluator.evaluated_tests();
+        record.query_tests_updated = evaluator.updated_tests();
+        Run_Metrics::shared().add_trajectory(record);
+
+        return result;
+    }
+
+    bool TRACE_Q::is_accepted(data_structures::Trajectory const& trajectory,
+                              spatial_queries::Query_Evaluator& evaluator) const {
+        return evaluator.accepts(trajectory, min_range_query_accuracy, min_knn_query_accuracy);
     }
 
     std::vector<std::shared_ptr<spatial_queries::Query>> TRACE_Q::initialize_query_tests(
@@ -44,21 +124,33 @@ namespace trace_q {
         auto range_query_y_range = range_query_mbr.y_high - range_query_mbr.y_low;
         auto range_query_time_range = static_cast<long double>(range_query_mbr.t_high - range_query_mbr.t_low);
 
-        for (int x_point = 0; x_point <= range_query_points_on_axis; ++x_point) {
-            // Scale the coordinate based on the grid density, the mbr and the current point on the x-axis.
-            auto x_coord = range_query_mbr.x_low + x_point * range_query_grid_density * range_query_x_range;
-            for (int y_point = 0; y_point <= range_query_points_on_axis; ++y_point) {
+        // The grid points are flattened, so that they can be initialized in chunks on the executor.
+        // Every grid point writes to its own slot, which keeps the order of the query objects deterministic.
+        auto const axis_points = static_cast<size_t>(range_query_points_on_axis + 1);
+        auto const t_points = static_cast<size_t>(range_query_time_points + 1);
+        std::vector<std::vector<std::shared_ptr<spatial_queries::Range_Query_Test>>> grid_point_queries(
+                axis_points * axis_points * t_points);
+
+        concurrency::Work_Stealing_Pool::shared().parallel_for(0, grid_point_queries.size(), [&](size_t begin, size_t end) {
+            for (auto grid_point = begin; grid_point < end; ++grid_point) {
+                auto x_point = static_cast<int>(grid_point / (axis_points * t_points));
+                auto y_point = static_cast<int>(grid_point / t_points % axis_points);
+                auto t_point = static_cast<int>(grid_point % t_points);
+
+                // Scale the coordinate based on the grid density, the mbr and the current point on the x-axis.
+                auto x_coord = range_query_mbr.x_low + x_point * range_query_grid_density * range_query_x_range;
                 auto y_coord = range_query_mbr.y_low + y_point * range_query_grid_density * range_query_y_range;
-                for (int t_point = 0; t_point <= range_query_time_points; ++t_point) {
-                    auto t_interval = static_cast<unsigned long>(std::round(range_query_mbr.t_low + t_point
-                                                                                                    * range_query_time_interval_multiplier * range_query_time_range));
-
-                    auto range_queries = range_query_initialization(original_trajectory,
-                                                                    x_coord, y_coord, t_interval, range_query_mbr);
-                    query_objects.insert(std::end(query_objects), std::make_move_iterator(std::begin(range_queries)),
-                                         std::make_move_iterator(std::end(range_queries)));
-                }
+                auto t_interval = static_cast<unsigned long>(std::round(range_query_mbr.t_low + t_point
+                                                                                                * range_query_time_interval_multiplier * range_query_time_range));
+
+                grid_point_queries[grid_point] = range_query_initialization(original_trajectory,
+                                                                            x_coord, y_coord, t_interval, range_query_mbr);
             }
+        });
+
+        for (auto& range_queries : grid_point_queries) {
+            query_objects.insert(std::end(query_objects), std::make_move_iterator(std::begin(range_queries)),
+                                 std::make_move_iterator(std::end(range_queries)));
         }
 
         if (use_KNN_for_query_accuracy) {
@@ -67,10 +159,8 @@ namespace trace_q {
             auto knn_query_points_on_axis = static_cast<int>(std::ceil(1 / knn_query_grid_density));
             auto knn_query_time_points = static_cast<int>(std::ceil(1 / knn_query_time_interval_multiplier));
 
-            // Here we run the knn queries asynchronously for each query time point.
-            // Note that here, the query time points should not be larger than the allowed connections to the database (100)
-            std::vector<std::future<std::shared_ptr<spatial_queries::KNN_Query_Test>>> knn_futures{};
-            knn_futures.reserve((knn_query_points_on_axis + 1) * (knn_query_points_on_axis + 1) * (knn_query_time_points + 1));
+            std::vector<spatial_queries::KNN_Query::KNN_Origin> knn_origins{};
+            knn_origins.reserve((knn_query_points_on_axis + 1) * (knn_query_points_on_axis + 1) * (knn_query_time_points + 2));
 
             auto knn_x_range = knn_query_mbr.x_high - knn_query_mbr.x_low;
             auto knn_y_range = knn_query_mbr.y_high - knn_query_mbr.y_low;
@@ -86,65 +176,38 @@ namespace trace_q {
                         auto t_interval = knn_query_mbr.t_low + static_cast<unsigned long>(t_point
                                 * knn_query_time_interval_multiplier * knn_time_range);
 
-                        knn_futures.emplace_back(std::async(std::launch::async, knn_query_initialization,
-                                                            original_trajectory.id, x_coord, y_coord, t_interval,
-                                                            knn_query_mbr, knn_query_time_interval_multiplier, knn_k));
-                        if (knn_futures.size() >= max_connections_per_batch_simplification) {
-                            for (auto& fut : knn_futures) {
-                                auto knn_query_test_pointer = fut.get();
-                                if (knn_query_test_pointer->original_in_result) {
-                                    query_objects.push_back(knn_query_test_pointer);
-                                }
-                            }
-                            knn_futures.clear();
-                        }
+                        knn_origins.push_back(knn_query_origin(x_coord, y_coord, t_interval, knn_query_mbr,
+                                                               knn_query_time_interval_multiplier));
                     }
 
-                    spatial_queries::KNN_Query::KNN_Origin origin{x_coord, y_coord, std::numeric_limits<unsigned long>::min(), std::numeric_limits<unsigned long>::max()};
-
-                    knn_futures.emplace_back(
-                            std::async(std::launch::async,
-                                       [this](unsigned int original_trajectory_id, spatial_queries::KNN_Query::KNN_Origin const& o)
-                                       { return std::make_shared<spatial_queries::KNN_Query_Test>(original_trajectory_id, knn_k, o); }, original_trajectory.id, origin));
-                }
-            }
-
-            for (auto& fut : knn_futures) {
-                auto knn_query_test_pointer = fut.get();
-                if (knn_query_test_pointer->original_in_result) {
-                    query_objects.push_back(knn_query_test_pointer);
+                    knn_origins.push_back({x_coord, y_coord, std::numeric_limits<unsigned long>::min(), std::numeric_limits<unsigned long>::max()});
                 }
             }
-        }
-
-        return query_objects;
-    }
-
-    TRACE_Q::Query_Accuracy TRACE_Q::query_accuracy(data_structures::Trajectory const& trajectory,
-                                   std::vector<std::shared_ptr<spatial_queries::Query>> const& query_objects) const {
-
-        std::vector<std::future<bool>> range_futures{};
-        std::vector<std::future<bool>> knn_futures{};
 
-        for (auto const& query_object : query_objects) {
-            if (auto range_query = std::dynamic_pointer_cast<spatial_queries::Range_Query_Test>(query_object)) {
-                range_futures.emplace_back(std::async(std::launch::async, *range_query, std::ref(trajectory)));
+            std::vector<std::shared_ptr<spatial_queries::KNN_Query_Test>> knn_tests(knn_origins.size());
+            if (knn_index) {
+                // The index answers the queries in memory, so they are evaluated in chunks on the executor
+                concurrency::Work_Stealing_Pool::shared().parallel_for(0, knn_origins.size(), [&](size_t begin, size_t end) {
+                    for (auto i = begin; i < end; ++i) {
+                        knn_tests[i] = std::make_shared<spatial_queries::KNN_Query_Test>(
+                                original_trajectory.id, knn_k, knn_origins[i],
+                                knn_index->get_ids_from_knn(knn_k + 1, knn_origins[i]));
+                    }
+                });
             }
-            if (auto knn_query = std::dynamic_pointer_cast<spatial_queries::KNN_Query_Test>(query_object)) {
-                knn_futures.emplace_back(std::async(std::launch::async, *knn_query, std::ref(trajectory)));
+            else {
+                // All origins are sent to the database as a single statement
+                knn_tests = spatial_queries::KNN_Query_Test::create_batch(original_trajectory.id, knn_k, knn_origins);
             }
-        }
-        int correct_range_queries = process_futures(range_futures);
-
-        auto range_query_f1 = static_cast<double>(correct_range_queries) / (correct_range_queries + 0.5 * (static_cast<double>(range_futures.size() - correct_range_queries)));
-        if (use_KNN_for_query_accuracy) {
-            int correct_knn_queries = process_futures(knn_futures);
-            auto knn_query_f1 = static_cast<double>(correct_knn_queries) / (correct_knn_queries + 0.5 * (static_cast<double>(knn_futures.size() - correct_knn_queries)));
 
-            return Query_Accuracy{range_query_f1, knn_query_f1};
+            for (auto& knn_test : knn_tests) {
+                if (knn_test->original_in_result) {
+                    query_objects.push_back(std::move(knn_test));
+                }
+            }
         }
 
-        return Query_Accuracy{range_query_f1, 0};
+        return query_objects;
     }
 
     TRACE_Q::MBR TRACE_Q::calculate_MBR(data_structures::Trajectory const& trajectory) {
@@ -177,7 +240,6 @@ namespace trace_q {
     std::vector<std::shared_ptr<spatial_queries::Range_Query_Test>> TRACE_Q::range_query_initialization(
             data_structures::Trajectory const& trajectory, double x, double y, unsigned long t, MBR const& mbr) const {
         std::vector<std::shared_ptr<spatial_queries::Range_Query_Test>> result{};
-        std::vector<std::future<spatial_queries::Range_Query_Test>> futures{};
 
         for (int window_number = 0; window_number < windows_per_grid_point; ++window_number) {
             auto [window_x_low, window_x_high] = calculate_window_range(
@@ -188,38 +250,23 @@ namespace trace_q {
                     t, mbr.t_low, mbr.t_high, window_expansion_rate,
                     range_query_time_interval_multiplier, window_number);
 
-            futures.emplace_back(
-                    std::async(std::launch::async,
-                               [](const data_structures::Trajectory& original_trajectory, double x_low,
-                                       double x_high, double y_low, double y_high, unsigned long t_low,
-                                       unsigned long t_high)
-                                       { return spatial_queries::Range_Query_Test{original_trajectory, x_low, x_high,
-                                                                                  y_low, y_high, t_low, t_high};
-                                           },
-                               trajectory, window_x_low, window_x_high, window_y_low,
-                               window_y_high, window_t_low, window_t_high));
-
-        }
-
-        for (auto& fut : futures) {
-            auto rq_test_result = fut.get();
-            if (rq_test_result.original_in_window) {
-                result.push_back(std::make_shared<spatial_queries::Range_Query_Test>(rq_test_result));
+            auto rq_test = std::make_shared<spatial_queries::Range_Query_Test>(
+                    trajectory, window_x_low, window_x_high, window_y_low, window_y_high, window_t_low, window_t_high);
+            if (rq_test->original_in_window) {
+                result.push_back(std::move(rq_test));
             }
         }
         return result;
     }
 
-    std::shared_ptr<spatial_queries::KNN_Query_Test> TRACE_Q::knn_query_initialization(
-            unsigned int original_trajectory_id,
-            double x, double y, unsigned long t, MBR const& mbr, double time_interval_multiplier, int knn_k) {
+    spatial_queries::KNN_Query::KNN_Origin TRACE_Q::knn_query_origin(
+            double x, double y, unsigned long t, MBR const& mbr, double time_interval_multiplier) {
 
         auto [t_low, t_high] = calculate_time_range(
                 t, mbr.t_low, mbr.t_high, 1,
                 time_interval_multiplier, 0);
 
-        spatial_queries::KNN_Query::KNN_Origin origin{x, y, t_low, t_high};
-        return std::make_shared<spatial_queries::KNN_Query_Test>(original_trajectory_id, knn_k, origin);
+        return spatial_queries::KNN_Query::KNN_Origin{x, y, t_low, t_high};
     }
 
     std::pair<double, double> TRACE_Q::calculate_window_range(
@@ -254,53 +301,63 @@ namespace trace_q {
         return {w_low, w_high};
     }
 
-    int TRACE_Q::process_futures(std::vector<std::future<bool>>& futures) {
-        int correct_queries = 0;
-        for (auto & fut : futures) {
-            if (fut.get()) {
-                correct_queries++;
-            }
-        }
-        return correct_queries;
+    std::string TRACE_Q::parameters() const {
+        std::stringstream description{};
+        description << std::setprecision(std::numeric_limits<double>::max_digits10)
+                    << "simplifier=" << simplifier_description
+                    << ";min_range_query_accuracy=" << min_range_query_accuracy
+                    << ";min_knn_query_accuracy=" << min_knn_query_accuracy
+                    << ";range_query_grid_density=" << range_query_grid_density
+                    << ";knn_query_grid_density=" << knn_query_grid_density
+                    << ";windows_per_grid_point=" << windows_per_grid_point
+                    << ";window_expansion_rate=" << window_expansion_rate
+                    << ";range_query_time_interval_multiplier=" << range_query_time_interval_multiplier
+                    << ";knn_query_time_interval_multiplier=" << knn_query_time_interval_multiplier
+                    << ";knn_k=" << knn_k
+                    << ";use_KNN_for_query_accuracy=" << use_KNN_for_query_accuracy
+                    << ";use_tolerance_bisection=" << use_tolerance_bisection;
+        return description.str();
     }
 
-    void TRACE_Q::run() const {
-        auto ids = trajectory_data_handling::Trajectory_Manager::db_get_all_trajectory_ids(
-                trajectory_data_handling::db_table::original_trajectories);
-
-        std::vector<unsigned int> working_ids{};
-        unsigned int counter = 0;
-
-        while(counter < ids.size()) {
-            for (int i = 0; i < max_trajectories_in_batch && counter < ids.size(); i++, counter++) {
-                working_ids.push_back(ids[counter]);
-            }
-            batch_job(working_ids);
-            working_ids.clear();
-        }
-    }
-
-    void TRACE_Q::batch_job(const std::vector<unsigned int> & ids) const {
+    Simplification_Pipeline::Stats TRACE_Q::run(bool incremental) const {
         using trajectory_data_handling::Trajectory_Manager;
         using trajectory_data_handling::db_table;
 
-        std::vector<std::future<bool>> futures{};
-        for (const auto& id : ids) {
-            futures.emplace_back(std::async(std::launch::async, [this](unsigned int t_id){
-                auto original_trajectory =
-                        Trajectory_Manager::load_into_data_structure(db_table::original_trajectories,
-                                                                     std::vector<unsigned int>{t_id}).front();
-                auto simplified_trajectory = simplify(original_trajectory);
-                Trajectory_Manager::insert_trajectory(simplified_trajectory,
-                                                      db_table::simplified_trajectories);
-                return true;
-            }, id));
+        Trajectory_Manager::create_simplified_metadata();
+        auto run_parameters = parameters();
+        auto ids = incremental ? Trajectory_Manager::db_get_unsimplified_trajectory_ids(run_parameters)
+                               : Trajectory_Manager::db_get_all_trajectory_ids(db_table::original_trajectories);
+
+        auto& metrics = Run_Metrics::shared();
+        metrics.start(ids.size());
+
+        auto batch_size = static_cast<size_t>(std::max(max_trajectories_in_batch, 1));
+        Simplification_Pipeline pipeline{
+                [&metrics](std::vector<unsigned int> const& batch_ids) {
+                    auto start = Run_Metrics::Clock::now();
+                    auto trajectories = Trajectory_Manager::load_into_data_structure(
+                            db_table::original_trajectories, batch_ids);
+                    metrics.add_stage_time(Run_Metrics::Stage::load, Run_Metrics::Clock::now() - start);
+                    return trajectories;
+                },
+                [this](data_structures::Trajectory const& trajectory) {
+                    return simplify(trajectory);
+                },
+                [&metrics, &run_parameters](std::vector<data_structures::Trajectory> const& simplifications) {
+                    auto start = Run_Metrics::Clock::now();
+                    Trajectory_Manager::insert_simplifications(simplifications, run_parameters);
+                    metrics.add_stage_time(Run_Metrics::Stage::insert, Run_Metrics::Clock::now() - start);
+                },
+                Simplification_Pipeline::Options{batch_size, 2 * batch_size}};
+
+        try {
+            auto stats = pipeline.run(ids);
+            metrics.finish();
+            return stats;
         }
-
-        for (auto& fut : futures) {
-            if (!fut.get()) {
-                throw std::runtime_error{"Batch job error: Future did not return"};
-            }
+        catch (...) {
+            metrics.finish();
+            throw;
         }
     }
 
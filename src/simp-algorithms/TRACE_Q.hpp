@@ -3,45 +3,84 @@
 
 #include <future>
 #include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <string>
 #include "../data/Trajectory.hpp"
 #include "../querying/Query.hpp"
 #include "../querying/Range_Query_Test.hpp"
 #include "../querying/KNN_Query_Test.hpp"
+#include "../querying/KNN_Index.hpp"
+#include "../querying/Query_Evaluator.hpp"
 #include "MRPA.hpp"
+#include "Simplification_Pipeline.hpp"
+#include "Run_Metrics.hpp"
 
 namespace trace_q {
 
     class TRACE_Q {
+    public:
+        /**
+         * A simplification algorithm that produces candidate simplifications with decreasing resolution, such as
+         * MRPA, TD-TR, SQUISH-E or OPW.
+         */
+        using Candidate_Generator =
+                std::function<std::vector<data_structures::Trajectory>(data_structures::Trajectory const&)>;
+
+        /**
+         * A candidate generator along with a stable description of the algorithm and its settings, which identifies
+         * the simplifications it produces in the run metadata.
+         */
+        struct Simplifier {
+            Candidate_Generator generate;
+            std::string description;
+
+            Simplifier() = default;
+
+            Simplifier(Candidate_Generator generate, std::string description)
+                    : generate(std::move(generate)), description(std::move(description)) {}
+
+            /**
+             * Wraps a simplification algorithm that describes itself, such as MRPA, TD-TR, SQUISH-E or OPW.
+             */
+            template<typename Algorithm>
+            requires requires(Algorithm const& algorithm) {
+                { algorithm.description() } -> std::convertible_to<std::string>;
+            }
+            Simplifier(Algorithm algorithm) // NOLINT(google-explicit-constructor)
+                    : generate(algorithm), description(algorithm.description()) {}
+        };
+
+    private:
         /**
          * The MRPA algorithm as a function object.
          */
         simp_algorithms::MRPA mrpa{};
 
         /**
-         * The minimum range query accuracy that the simplification method must uphold.
+         * The algorithm that produces the candidate simplifications, which is MRPA unless another one is given.
          */
-        double min_range_query_accuracy{};
+        Candidate_Generator candidate_generator{};
 
         /**
-         * The minimum knn query accuracy that the simplification method must uphold.
+         * The description of the algorithm that produces the candidate simplifications.
          */
-        double min_knn_query_accuracy{};
+        std::string simplifier_description{};
 
         /**
-         * The maximum number of trajectories per batch that is able to run concurrently due to database connections.
+         * The minimum range query accuracy that the simplification method must uphold.
          */
-        int max_trajectories_in_batch{};
+        double min_range_query_accuracy{};
 
         /**
-         * The maximum amount of threads that are allowed to run database client connections to the PostgreSQL database.
+         * The minimum knn query accuracy that the simplification method must uphold.
          */
-        int max_threads{};
+        double min_knn_query_accuracy{};
 
         /**
-         * The maximum amount of client connections per used in KNN part of the initialize_query_tests defined by
-         * max_trajectories_in_batch and max_threads.
+         * The number of trajectories that are loaded from and inserted into the database at a time.
          */
-        int max_connections_per_batch_simplification{};
+        int max_trajectories_in_batch{};
 
         /**
          * The factor with which we will scale the grid for range queries.
@@ -100,8 +139,6 @@ namespace trace_q {
          * The factor that will be used to scale time intervals for each window in get_ids_from_knn queries.
          * Lower values will result in more queries.
          * Possible values: 0.1, 1
-         * Lowest allowed KNN time interval multiplier is 0.02, otherwise number of query time points would be larger
-         * than the allowed database connections.
          */
         double knn_query_time_interval_multiplier{};
 
@@ -115,6 +152,19 @@ namespace trace_q {
          */
         bool use_KNN_for_query_accuracy{};
 
+        /**
+         * Decides whether simplify bisects over the MRPA error tolerances, simplifying the original trajectory only
+         * at the tolerances it tests, instead of computing every MRPA level up front and testing them from the
+         * coarsest. Assumes that query accuracy decreases as the error tolerance increases.
+         */
+        bool use_tolerance_bisection{};
+
+        /**
+         * The in-memory index of the original trajectories that answers the KNN queries of the query tests.
+         * Without an index, every KNN query is sent to the database.
+         */
+        std::shared_ptr<spatial_queries::KNN_Index const> knn_index{};
+
         /**
          * A Minimum Bounding Rectangle for trajectory data.
          */
@@ -127,26 +177,6 @@ namespace trace_q {
             unsigned long t_high{};
         };
 
-        /**
-         * Struct describing the f1-scores of range and knn queries performed on the simplified trajectory.
-         */
-        struct Query_Accuracy {
-            double range_f1{};
-            double knn_f1{};
-        };
-
-        /**
-         * Calculates the query error of a simplified trajectory on a set of query objects.
-         * This is more accurately a query accuracy, since it is a percentage queries that return correct results.
-         * @param trajectory Simplified trajectory
-         * @param query_objects Vector of query objects that define a query and contain the original trajectory's result
-         * @return Query accuracy
-         */
-        [[nodiscard]] Query_Accuracy query_accuracy(
-                data_structures::Trajectory const& trajectory,
-                std::vector<std::shared_ptr<spatial_queries::Query>> const& query_objects) const;
-
-
         /**
          * Calculates the Minimum Bounding Rectangle for a given trajectory.
          * @param trajectory The Trajectory for which to calculate the MBR.
@@ -174,18 +204,17 @@ namespace trace_q {
                 data_structures::Trajectory const& trajectory, double x, double y, unsigned long t, MBR const& mbr) const;
 
         /**
-         * Initializes a list of KNN query objects with the given trajectory used to perform query similarity between
-         * KNN queries containing the original trajectory and the simplified counter-part.
-         * @param trajectory The original trajectory for which range queries will be performed.
+         * Calculates the origin of a KNN query at a grid point, whose time interval is centered around the t-axis
+         * grid point.
          * @param x The x-axis grid point.
          * @param y The y-axis grid point.
          * @param t The t-axis grid point.
          * @param mbr The Minimum Bounding Rectangle that encompasses the Trajectory.
-         * @return A shared pointer to a KNN query object that have been initialized with the given trajectory.
+         * @param time_interval_multiplier The multiplier used to scale the time interval of the query.
+         * @return The origin of the KNN query.
          */
-        static std::shared_ptr<spatial_queries::KNN_Query_Test> knn_query_initialization(
-                unsigned int original_trajectory_id,
-                double x, double y, unsigned long t, MBR const& mbr, double time_interval_multiplier, int knn_k);
+        static spatial_queries::KNN_Query::KNN_Origin knn_query_origin(
+                double x, double y, unsigned long t, MBR const& mbr, double time_interval_multiplier);
 
         /**
          * This function calculates the lower and upper bounds of a window range centered around a given value,
@@ -227,28 +256,35 @@ namespace trace_q {
         [[nodiscard]] std::vector<std::shared_ptr<spatial_queries::Query>> initialize_query_tests(
                 data_structures::Trajectory const& original_trajectory) const;
 
-        static int process_futures(std::vector<std::future<bool>>& futures);
+        [[nodiscard]] data_structures::Trajectory simplify(const data_structures::Trajectory& original_trajectory) const;
 
         /**
-         * Runs a single batch of the TRACE-Q algorithm given the list of trajectory IDs.
-         * The original trajectories are fetched from the database, simplified using the TRACE-Q algorithm which
-         * utilizes MRPA, and then inserted into the database for later querying. The batch is run concurrently for
-         * each trajectory.
-         * @param ids The list of trajectory IDs for which the batch job will run.
+         * Finds the coarsest simplification that upholds the minimum query accuracies by bisecting over the MRPA error
+         * tolerances, so only O(log L) of the L levels are computed and tested.
+         * @param original_trajectory The trajectory to be simplified.
+         * @return The accepted simplification, or the original trajectory if no level upholds the accuracies.
          */
-        void batch_job(std::vector<unsigned int> const& ids) const;
+        [[nodiscard]] data_structures::Trajectory simplify_by_bisection(
+                const data_structures::Trajectory& original_trajectory) const;
 
-        [[nodiscard]] data_structures::Trajectory simplify(const data_structures::Trajectory& original_trajectory) const;
+        /**
+         * Determines whether a simplified trajectory upholds the minimum range and knn query accuracies, stopping as
+         * soon as the query tests evaluated so far decide it.
+         * @param trajectory Simplified trajectory
+         * @param evaluator The evaluator of the query tests of the original trajectory
+         */
+        [[nodiscard]] bool is_accepted(data_structures::Trajectory const& trajectory,
+                                       spatial_queries::Query_Evaluator& evaluator) const;
 
     public:
         /**
          * The TRACE_Q constructor that determines the query_amount based on the given parameters.
          * @param resolution_scale The MRPA resolution scale.
          * @param min_range_query_accuracy The minimum range query accuracy that the simplification method must uphold.
-         * @param max_trajectories_in_batch The maximum number of trajectories per batch that is able to run
-         * concurrently due to database connections.
-         * @param max_threads The maximum amount of threads that are allowed to run database client connections to
-         * the PostgreSQL database.
+         * @param max_trajectories_in_batch The number of trajectories that are loaded from and inserted into the
+         * database at a time.
+         * @param max_threads Unused. The KNN queries of a trajectory are a single statement, and database connections
+         * are bounded by the shared connection pool.
          * @param range_query_grid_density_multiplier The grid density factor for range queries,
          * which describes how close points appear in the grid.
          * @param windows_per_grid_point The amount of windows per point in the grid.
@@ -256,23 +292,31 @@ namespace trace_q {
          * @param range_query_time_interval_multiplier The multiplier used to scale the time interval for each window
          * in range queries.
          * @param use_KNN_for_query_accuracy Decides whether KNN queries should be utilized for determining query accuracy.
+         * @param use_tolerance_bisection Decides whether simplify bisects over the MRPA error tolerances.
+         * @param simplifier The algorithm that produces the candidate simplifications and its description. Defaults
+         * to MRPA with the given resolution scale. Tolerance bisection requires MRPA.
          */
-        TRACE_Q(double resolution_scale, double min_range_query_accuracy, int max_trajectories_in_batch, int max_threads,
+        TRACE_Q(double resolution_scale, double min_range_query_accuracy, int max_trajectories_in_batch, [[maybe_unused]] int max_threads,
                 double range_query_grid_density_multiplier,  int windows_per_grid_point,
-                double window_expansion_rate, double range_query_time_interval_multiplier, bool use_KNN_for_query_accuracy)
+                double window_expansion_rate, double range_query_time_interval_multiplier, bool use_KNN_for_query_accuracy,
+                bool use_tolerance_bisection = false, Simplifier simplifier = {})
                 : mrpa(resolution_scale),
+                  candidate_generator(simplifier.generate ? simplifier.generate : Candidate_Generator{mrpa}),
+                  simplifier_description(simplifier.generate ? simplifier.description : mrpa.description()),
                   min_range_query_accuracy(min_range_query_accuracy),
                   max_trajectories_in_batch(max_trajectories_in_batch),
-                  max_threads(max_threads),
-                  max_connections_per_batch_simplification(max_threads / max_trajectories_in_batch),
                   range_query_grid_expansion_factor(range_query_grid_density_multiplier * 0.8),
                   range_query_grid_density(range_query_grid_density_multiplier),
                   windows_per_grid_point(windows_per_grid_point),
                   window_expansion_rate(window_expansion_rate),
                   range_query_time_interval_multiplier(range_query_time_interval_multiplier),
-                  use_KNN_for_query_accuracy(use_KNN_for_query_accuracy) {
-            if (max_connections_per_batch_simplification == 0) {
-                throw std::invalid_argument("max_connections_per_batch_simplification is too low");
+                  use_KNN_for_query_accuracy(use_KNN_for_query_accuracy),
+                  use_tolerance_bisection(use_tolerance_bisection) {
+            if (use_tolerance_bisection && simplifier.generate) {
+                throw std::invalid_argument("use_tolerance_bisection requires MRPA candidates");
+            }
+            if (simplifier.generate && simplifier.description.empty()) {
+                throw std::invalid_argument("A candidate generator requires a description");
             }
         }
 
@@ -281,10 +325,10 @@ namespace trace_q {
          * @param resolution_scale The MRPA resolution scale.
          * @param min_range_query_accuracy The minimum range query accuracy that the simplification method must uphold.
          * @param min_knn_query_accuracy The minimum knn query accuracy that the simplification method must uphold.
-         * @param max_trajectories_in_batch The maximum number of trajectories per batch that is able to run
-         * concurrently due to database connections.
-         * @param max_threads The maximum amount of threads that are allowed to run database client connections to
-         * the PostgreSQL database.
+         * @param max_trajectories_in_batch The number of trajectories that are loaded from and inserted into the
+         * database at a time.
+         * @param max_threads Unused. The KNN queries of a trajectory are a single statement, and database connections
+         * are bounded by the shared connection pool.
          * @param range_query_grid_density_multiplier The grid density factor for range queries,
          * which describes how close points appear in the grid.
          * @param knn_query_grid_density_multiplier The grid density factor for KNN queries,
@@ -297,18 +341,22 @@ namespace trace_q {
          * in KNN queries.
          * @param knn_k The K value for K-Nearest-Neighbour queries.
          * @param use_KNN_for_query_accuracy Decides whether KNN queries should be utilized for determining query accuracy.
+         * @param use_tolerance_bisection Decides whether simplify bisects over the MRPA error tolerances.
+         * @param simplifier The algorithm that produces the candidate simplifications and its description. Defaults
+         * to MRPA with the given resolution scale. Tolerance bisection requires MRPA.
          */
-        TRACE_Q(double resolution_scale, double min_range_query_accuracy, double min_knn_query_accuracy, int max_trajectories_in_batch, int max_threads,
+        TRACE_Q(double resolution_scale, double min_range_query_accuracy, double min_knn_query_accuracy, int max_trajectories_in_batch, [[maybe_unused]] int max_threads,
                 double range_query_grid_density_multiplier,
                 double knn_query_grid_density_multiplier,  int windows_per_grid_point,
                 double window_expansion_rate, double range_query_time_interval_multiplier,
-                double knn_query_time_interval_multiplier, int knn_k, bool use_KNN_for_query_accuracy)
+                double knn_query_time_interval_multiplier, int knn_k, bool use_KNN_for_query_accuracy,
+                bool use_tolerance_bisection = false, Simplifier simplifier = {})
                 : mrpa(resolution_scale),
+                  candidate_generator(simplifier.generate ? simplifier.generate : Candidate_Generator{mrpa}),
+                  simplifier_description(simplifier.generate ? simplifier.description : mrpa.description()),
                   min_range_query_accuracy(min_range_query_accuracy),
                   min_knn_query_accuracy(min_knn_query_accuracy),
                   max_trajectories_in_batch(max_trajectories_in_batch),
-                  max_threads(max_threads),
-                  max_connections_per_batch_simplification(max_threads / max_trajectories_in_batch),
                   range_query_grid_expansion_factor(range_query_grid_density_multiplier * 0.8),
                   knn_query_grid_expansion_factor(knn_query_grid_density_multiplier * 0.8),
                   range_query_grid_density(range_query_grid_density_multiplier),
@@ -318,16 +366,42 @@ namespace trace_q {
                   range_query_time_interval_multiplier(range_query_time_interval_multiplier),
                   knn_query_time_interval_multiplier(knn_query_time_interval_multiplier),
                   knn_k(knn_k),
-                  use_KNN_for_query_accuracy(use_KNN_for_query_accuracy) {
-            if (max_connections_per_batch_simplification == 0) {
-                throw std::invalid_argument("max_connections_per_batch_simplification is too low");
+                  use_KNN_for_query_accuracy(use_KNN_for_query_accuracy),
+                  use_tolerance_bisection(use_tolerance_bisection) {
+            if (use_tolerance_bisection && simplifier.generate) {
+                throw std::invalid_argument("use_tolerance_bisection requires MRPA candidates");
+            }
+            if (simplifier.generate && simplifier.description.empty()) {
+                throw std::invalid_argument("A candidate generator requires a description");
             }
         }
 
         /**
-         * Runs the TRACE-Q algorithm in batches with MRPA.
+         * Runs the TRACE-Q algorithm on the original trajectories. The original trajectories are loaded from the
+         * database, simplified and inserted into the database in a pipeline, which loads and inserts
+         * max_trajectories_in_batch trajectories at a time while the simplification workers run.
+         * Every inserted batch replaces earlier simplifications of its trajectories and is recorded in the run
+         * metadata in the same transaction, so an interrupted run resumes from its last batch when run incrementally.
+         * The time of every stage and the number of query tests and levels are recorded in Run_Metrics::shared().
+         * @param incremental Whether to only simplify the original trajectories that have not been simplified with
+         * the same parameters, or that have changed since. Otherwise, every original trajectory is simplified.
+         * @return The throughput of the stages of the pipeline and the depth of its queues.
          */
-        void run() const;
+        Simplification_Pipeline::Stats run(bool incremental = false) const;
+
+        /**
+         * Describes the parameters that decide the simplifications, which the run metadata records for every
+         * simplified trajectory. Runs with the same description produce the same simplifications.
+         */
+        [[nodiscard]] std::string parameters() const;
+
+        /**
+         * Answers the KNN queries of the query tests with the given index instead of the database.
+         * @param index The index of the original trajectories, or nullptr to query the database.
+         */
+        void use_knn_index(std::shared_ptr<spatial_queries::KNN_Index const> index) {
+            knn_index = std::move(index);
+        }
 
     };
 
@@ -49,7 +49,7 @@ namespace trajectory_data_handling {
         }
     }
 
-    void File_Manager::load_tdrive_dataset(int number_of_files) {
+    void File_Manager::load_tdrive_dataset(int number_of_files, size_t batch_size) {
 
         // The following values are used for data-cleaning in order to remove outliers.
         auto min_accepted_latitude = 30.69;
@@ -59,6 +59,7 @@ namespace trajectory_data_handling {
 
         auto random_file_indexes = get_random_file_indexes(TDRIVE_PATH, number_of_files);
 
+        std::vector<data_structures::Trajectory> batch{};
         int index_counter{0};
         for (const auto& dirEntry : recursive_directory_iterator(TDRIVE_PATH)) {
             if (number_of_files == 0 || random_file_indexes.contains(index_counter)) {
@@ -102,8 +103,7 @@ namespace trajectory_data_handling {
                     file.close();
 
                     if (trajectory.size() != 0) {
-                        trajectory_data_handling::Trajectory_Manager::insert_trajectory(
-                                trajectory, trajectory_data_handling::db_table::original_trajectories);
+                        add_to_batch(std::move(trajectory), batch, batch_size);
                     }
                 } else {
                     throw std::runtime_error("Error opening file: " + dirEntry.path().string());
@@ -112,12 +112,15 @@ namespace trajectory_data_handling {
 
             index_counter++;
         }
+
+        Trajectory_Manager::insert_trajectories(batch, db_table::original_trajectories);
     }
 
-    void File_Manager::load_geolife_dataset(int number_of_files) {
+    void File_Manager::load_geolife_dataset(int number_of_files, size_t batch_size) {
 
         auto random_file_indexes = get_random_file_indexes(GEOLIFE_PATH, number_of_files);
 
+        std::vector<data_structures::Trajectory> batch{};
         int index_counter{0};
         unsigned trajectory_id = 1;
         for (const auto &dirEntry: recursive_directory_iterator(GEOLIFE_PATH)) {
@@ -172,8 +175,7 @@ namespace trajectory_data_handling {
                     file.close();
 
                     if (!trajectory.locations.empty()) {
-                        trajectory_data_handling::Trajectory_Manager::insert_trajectory(
-                                trajectory, trajectory_data_handling::db_table::original_trajectories);
+                        add_to_batch(std::move(trajectory), batch, batch_size);
                     }
                 } else {
                     throw std::runtime_error("Error opening file: " + dirEntry.path().string());
@@ -182,6 +184,17 @@ namespace trajectory_data_handling {
 
             index_counter++;
         }
+
+        Trajectory_Manager::insert_trajectories(batch, db_table::original_trajectories);
+    }
+
+    void File_Manager::add_to_batch(data_structures::Trajectory&& trajectory,
+                                    std::vector<data_structures::Trajectory>& batch, size_t batch_size) {
+        batch.push_back(std::move(trajectory));
+        if (batch.size() >= batch_size) {
+            Trajectory_Manager::insert_trajectories(batch, db_table::original_trajectories);
+            batch.clear();
+        }
     }
 
     std::unordered_set<int> File_Manager::get_random_file_indexes(std::filesystem::path const& path, int number_of_indexes) {
@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <fstream>
 #include <unordered_set>
+#include <vector>
 #include "../data/Trajectory.hpp"
 
 namespace trajectory_data_handling {
@@ -16,18 +17,26 @@ namespace trajectory_data_handling {
        static char delimiter;
 
        static std::unordered_set<int> get_random_file_indexes(std::filesystem::path const& path, int number_of_indexes);
+
+       /**
+        * Adds a trajectory to a batch, and inserts and clears the batch once it holds batch_size trajectories.
+        */
+       static void add_to_batch(data_structures::Trajectory&& trajectory,
+                                std::vector<data_structures::Trajectory>& batch, size_t batch_size);
    public:
        /**
         * Loads the T-Drive dataset files into the database.
         * @param number_of_files The number of random files to fetch. If number_of_indexes = 0, all files are loaded.
+        * @param batch_size The number of trajectories inserted and committed at a time.
         */
-       static void load_tdrive_dataset(int number_of_files = 0);
+       static void load_tdrive_dataset(int number_of_files = 0, size_t batch_size = 64);
 
        /**
         * Loads the Geolife dataset files into the database.
         * @param number_of_files The number of random files to fetch. If number_of_indexes = 0, all files are loaded.
+        * @param batch_size The number of trajectories inserted and committed at a time.
         */
-       static void load_geolife_dataset(int number_of_files = 0);
+       static void load_geolife_dataset(int number_of_files = 0, size_t batch_size = 64);
 
        static unsigned long string_to_time(const std::string& timeString);
    };
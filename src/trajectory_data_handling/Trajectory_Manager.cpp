@@ -1,52 +1,109 @@
+#include <array>
+#include <charconv>
 #include <iostream>
 #include <fstream>
 #include <pqxx/pqxx>
 #include "Trajectory_Manager.hpp"
 #include "File_Manager.hpp"
+#include "../database/Connection_Pool.hpp"
 
 namespace trajectory_data_handling {
 
-    std::string Trajectory_Manager::connection_string{"user=postgres password=postgres host=localhost dbname=traceq port=5432"};
+    namespace {
+        /**
+         * Formats a location as the text of a PostgreSQL point. Unlike std::to_string, std::to_chars keeps every
+         * digit needed to read the coordinates back unchanged.
+         * @param buffer Holds the text, which is valid until the buffer is reused.
+         */
+        std::string_view point_text(std::array<char, 64>& buffer, double longitude, double latitude) {
+            auto* end = buffer.data();
+            auto* last = buffer.data() + buffer.size();
+            *end++ = '(';
+            end = std::to_chars(end, last, longitude).ptr;
+            *end++ = ',';
+            end = std::to_chars(end, last, latitude).ptr;
+            *end++ = ')';
+            return {buffer.data(), static_cast<size_t>(end - buffer.data())};
+        }
+
+        /**
+         * Formats the IDs of trajectories as a comma-separated list.
+         */
+        std::string id_list(std::vector<data_structures::Trajectory> const& trajectories) {
+            std::stringstream list{};
+            for (auto i = trajectories.cbegin(); i != trajectories.cend(); ++i) {
+                list << i->id;
+                if (std::next(i) != trajectories.cend()) {
+                    list << ",";
+                }
+            }
+            return list.str();
+        }
+    }
 
     void Trajectory_Manager::insert_trajectory(data_structures::Trajectory const& trajectory, db_table table) {
-        auto table_name = get_table_name(table);
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
+        copy_into_transaction({&trajectory, 1}, table, txn);
+        txn.commit();
+    }
 
-        pqxx::connection c{connection_string};
-        pqxx::work txn{c};
+    void Trajectory_Manager::insert_trajectories(std::vector<data_structures::Trajectory> const& trajectories,
+                                                 db_table table) {
+        if (trajectories.empty()) {
+            return;
+        }
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
+        copy_into_transaction(trajectories, table, txn);
+        txn.commit();
+    }
 
-        std::stringstream first_query{};
-        first_query << "INSERT INTO " << table_name << "(trajectory_id, coordinates, time) " << " VALUES("
-                    << trajectory.id << ", point(" << std::to_string(trajectory[0].longitude) << ", " << std::to_string(trajectory[0].latitude) << "), "
-                    << std::to_string(trajectory[0].timestamp) << ");";
+    void Trajectory_Manager::insert_simplifications(std::vector<data_structures::Trajectory> const& simplifications,
+                                                    std::string const& parameters) {
+        if (simplifications.empty()) {
+            return;
+        }
+        auto ids = id_list(simplifications);
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
 
-        txn.exec0(first_query.str());
+        // Replaces the simplifications of earlier runs, such as those of originals that have changed since
+        txn.exec0("DELETE FROM simplified_trajectories WHERE trajectory_id IN (" + ids + ");");
+        copy_into_transaction(simplifications, db_table::simplified_trajectories, txn);
 
-        if (table == db_table::original_trajectories) {
-            for (int i = 1; i < trajectory.size(); i++) {
-                if (trajectory[i].timestamp != trajectory[i - 1].timestamp) {
-                    std::stringstream query{};
-                    query << "INSERT INTO " << table_name << "(trajectory_id, coordinates, time) " << " VALUES("
-                          << trajectory.id << ", point(" << std::to_string(trajectory[i].longitude) << ", "
-                          << std::to_string(trajectory[i].latitude) << "), "
-                          << std::to_string(trajectory[i].timestamp) << ");";
+        std::stringstream query{};
+        query << "INSERT INTO simplified_trajectories_metadata "
+              << "(trajectory_id, parameters, original_points, original_last_point_id, simplified_at) "
+              << "SELECT trajectory_id, " << txn.quote(parameters) << ", COUNT(*), MAX(id), now() "
+              << "FROM original_trajectories WHERE trajectory_id IN (" << ids << ") GROUP BY trajectory_id "
+              << "ON CONFLICT (trajectory_id) DO UPDATE SET parameters = EXCLUDED.parameters, "
+              << "original_points = EXCLUDED.original_points, "
+              << "original_last_point_id = EXCLUDED.original_last_point_id, "
+              << "simplified_at = EXCLUDED.simplified_at;";
+        txn.exec0(query.str());
+        txn.commit();
+    }
 
-                    txn.exec0(query.str());
+    void Trajectory_Manager::copy_into_transaction(std::span<data_structures::Trajectory const> trajectories,
+                                                   db_table table, pqxx::work& txn) {
+        auto table_name = get_table_name(table);
+        auto stream = pqxx::stream_to::table(txn, {table_name}, {"trajectory_id", "coordinates", "time"});
+
+        std::array<char, 64> buffer{};
+        for (auto const& trajectory : trajectories) {
+            for (size_t i = 0; i < trajectory.size(); i++) {
+                // Original trajectories leave out locations with the same timestamp as the one before them
+                if (table == db_table::original_trajectories && i > 0
+                    && trajectory[i].timestamp == trajectory[i - 1].timestamp) {
+                    continue;
                 }
+                stream.write_values(trajectory.id,
+                                    point_text(buffer, trajectory[i].longitude, trajectory[i].latitude),
+                                    trajectory[i].timestamp);
             }
         }
-        else if (table == db_table::simplified_trajectories) {
-            for (int i = 1; i < trajectory.size(); i++) {
-                std::stringstream query{};
-                query << "INSERT INTO " << table_name << "(trajectory_id, coordinates, time) " << " VALUES("
-                      << trajectory.id << ", point(" << std::to_string(trajectory[i].longitude) << ", "
-                      << std::to_string(trajectory[i].latitude) << "), "
-                      << std::to_string(trajectory[i].timestamp) << ");";
-
-                txn.exec0(query.str());
-            }
-        }
-
-        txn.commit();
+        stream.complete();
     }
 
      std::vector<data_structures::Trajectory> Trajectory_Manager::load_into_data_structure(
@@ -68,8 +125,8 @@ namespace trajectory_data_handling {
             query << ") ORDER BY trajectory_id;";
         }
 
-        pqxx::connection c{connection_string};
-        pqxx::work txn{c};
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
         pqxx::result query_res{txn.exec(query.str())};
         txn.commit();
         std::vector<data_structures::Trajectory> res{};
@@ -128,43 +185,61 @@ namespace trajectory_data_handling {
     }
 
     void Trajectory_Manager::create_database() {
-        pqxx::connection c{connection_string};
-        pqxx::work txn{c};
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
 
         add_query_file_to_transaction("../../sql/create_table_original.sql", txn);
         add_query_file_to_transaction("../../sql/create_table_simplified.sql", txn);
+        add_query_file_to_transaction("../../sql/create_table_simplified_metadata.sql", txn);
 
         txn.commit();
     }
 
     void Trajectory_Manager::create_simplified_database() {
-        pqxx::connection c{connection_string};
-        pqxx::work txn{c};
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
 
         add_query_file_to_transaction("../../sql/create_table_simplified.sql", txn);
+        add_query_file_to_transaction("../../sql/create_table_simplified_metadata.sql", txn);
 
         txn.commit();
     }
 
-    void Trajectory_Manager::reset_all_data() {
-        pqxx::connection c{connection_string};
-        pqxx::work txn{c};
-        txn.exec0("DROP INDEX IF EXISTS original_trajectories_index;");
-        txn.exec0("DROP TABLE IF EXISTS original_trajectories;");
-        txn.exec0("DROP INDEX IF EXISTS simplified_trajectories_index;");
-        txn.exec0("DROP TABLE IF EXISTS simplified_trajectories;");
+    void Trajectory_Manager::create_simplified_metadata() {
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
+
+        add_query_file_to_transaction("../../sql/create_table_simplified_metadata.sql", txn);
 
         txn.commit();
+    }
+
+    void Trajectory_Manager::reset_all_data() {
+        // The connection is returned to the pool before create_database leases one of its own
+        {
+            auto connection = database::Connection_Pool::shared().acquire();
+            pqxx::work txn{*connection};
+            txn.exec0("DROP INDEX IF EXISTS original_trajectories_index;");
+            txn.exec0("DROP TABLE IF EXISTS original_trajectories;");
+            txn.exec0("DROP INDEX IF EXISTS simplified_trajectories_index;");
+            txn.exec0("DROP TABLE IF EXISTS simplified_trajectories;");
+            txn.exec0("DROP TABLE IF EXISTS simplified_trajectories_metadata;");
+
+            txn.commit();
+        }
         create_database();
     }
 
     void Trajectory_Manager::reset_simplified_data() {
-        pqxx::connection c{connection_string};
-        pqxx::work txn{c};
-        txn.exec0("DROP INDEX IF EXISTS simplified_trajectories_index;");
-        txn.exec0("DROP TABLE IF EXISTS simplified_trajectories;");
-
-        txn.commit();
+        {
+            auto connection = database::Connection_Pool::shared().acquire();
+            pqxx::work txn{*connection};
+            txn.exec0("DROP INDEX IF EXISTS simplified_trajectories_index;");
+            txn.exec0("DROP TABLE IF EXISTS simplified_trajectories;");
+            txn.exec0("DROP TABLE IF EXISTS simplified_trajectories_metadata;");
+
+            txn.commit();
+        }
         create_simplified_database();
     }
 
@@ -193,8 +268,36 @@ namespace trajectory_data_handling {
 
         query << "SELECT DISTINCT trajectory_id FROM " << table_name << ";";
 
-        pqxx::connection c{connection_string};
-        pqxx::work txn{c};
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
+
+        auto query_result = txn.query<int>(query.str());
+        txn.commit();
+
+        auto result = std::vector<unsigned int>{};
+        for (auto& [id] : query_result) {
+            result.emplace_back(id);
+        }
+
+        return result;
+    }
+
+    std::vector<unsigned int> Trajectory_Manager::db_get_unsimplified_trajectory_ids(std::string const& parameters) {
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
+
+        // An original has changed if points have been added to or removed from it since it was simplified. Points
+        // are only ever inserted, so their number and the largest point ID tell whether it has.
+        std::stringstream query{};
+        query << "SELECT original.trajectory_id FROM "
+              << "(SELECT trajectory_id, COUNT(*) AS points, MAX(id) AS last_point_id "
+              << "FROM original_trajectories GROUP BY trajectory_id) AS original "
+              << "LEFT JOIN simplified_trajectories_metadata AS metadata "
+              << "ON metadata.trajectory_id = original.trajectory_id "
+              << "AND metadata.parameters = " << txn.quote(parameters) << " "
+              << "AND metadata.original_points = original.points "
+              << "AND metadata.original_last_point_id = original.last_point_id "
+              << "WHERE metadata.trajectory_id IS NULL ORDER BY original.trajectory_id;";
 
         auto query_result = txn.query<int>(query.str());
         txn.commit();
@@ -210,8 +313,8 @@ namespace trajectory_data_handling {
     bool Trajectory_Manager::get_db_status() {
         std::stringstream query{};
 
-        pqxx::connection c{connection_string};
-        pqxx::work txn{c};
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
 
         query << "SELECT COUNT(DISTINCT trajectory_id) FROM original_trajectories;";
         int original_count = txn.exec1(query.str())[0].as<int>();
@@ -228,8 +331,8 @@ namespace trajectory_data_handling {
     std::vector<data_structures::Trajectory> Trajectory_Manager::get_trajectory_from_id_table_date(int trajectory_id, trajectory_data_handling::db_table table, const std::string& date){
         auto table_name = get_table_name(table);
         std::stringstream datestream{};
-        pqxx::connection c{connection_string};
-        pqxx::work txn{c};
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
 
         datestream << date << " 00:00:00";
         auto date_start = File_Manager::string_to_time(datestream.str());
@@ -279,8 +382,8 @@ namespace trajectory_data_handling {
 
     std::vector<std::string> Trajectory_Manager::get_dates_from_id(int trajectory_id){
         std::stringstream datestream{};
-        pqxx::connection c{connection_string};
-        pqxx::work txn{c};
+        auto connection = database::Connection_Pool::shared().acquire();
+        pqxx::work txn{*connection};
 
         std::stringstream query{};
         query << "SELECT DISTINCT to_char(to_timestamp(time), 'YYYY-MM-DD') as date FROM original_trajectories WHERE trajectory_id =" << trajectory_id << ";";
@@ -1,6 +1,7 @@
 #ifndef P8_PROJECT_TRAJECTORY_H
 #define P8_PROJECT_TRAJECTORY_H
 
+#include <span>
 #include <vector>
 #include <pqxx/pqxx>
 #include "../data/Trajectory.hpp"
@@ -22,11 +23,31 @@ namespace trajectory_data_handling {
 
         /**
          * Inserts a given trajectory into either the original or simplified database. Also removes duplicate points before inserting.
+         * The points are streamed to the database with COPY rather than inserted one statement at a time.
          * @param trajectory The trajectory to insert
          * @param table The table to insert into
          */
         static void insert_trajectory(data_structures::Trajectory const& trajectory, db_table table);
 
+        /**
+         * Inserts the given trajectories into either the original or simplified database in a single transaction and
+         * a single COPY, like insert_trajectory. Callers that write many trajectories commit per batch by calling this
+         * once for every batch.
+         * @param trajectories The trajectories to insert
+         * @param table The table to insert into
+         */
+        static void insert_trajectories(std::vector<data_structures::Trajectory> const& trajectories, db_table table);
+
+        /**
+         * Inserts simplified trajectories in a single transaction, replacing any earlier simplifications of the same
+         * trajectories, and records in the run metadata that they have been simplified with the given parameters.
+         * Every committed call is a checkpoint from which an incremental run resumes.
+         * @param simplifications The simplified trajectories, with the IDs of their original trajectories.
+         * @param parameters A description of the parameters the trajectories were simplified with.
+         */
+        static void insert_simplifications(std::vector<data_structures::Trajectory> const& simplifications,
+                                           std::string const& parameters);
+
         /**
          * Loads a vector of trajectories from the database. If a list of ids are not given, all trajectories are loaded.
          * @param table The table to load trajectories from.
@@ -48,17 +69,23 @@ namespace trajectory_data_handling {
         static void create_database();
 
         /**
-         * Constructs only the simplified table and index.
+         * Constructs only the simplified tables and indexes.
          */
         static void create_simplified_database();
 
+        /**
+         * Constructs the run metadata table, which records the parameters and time with which every original
+         * trajectory was last simplified, unless it already exists.
+         */
+        static void create_simplified_metadata();
+
         /**
          * Drops all tables and indexes, whereafter it calls create_database to reconstruct the tables.
          */
         static void reset_all_data();
 
         /**
-         * Drops only the simplified table and index, whereafter it calls create_simplified_database to reconstruct the tables.
+         * Drops only the simplified tables and indexes, whereafter it calls create_simplified_database to reconstruct the tables.
          */
         static void reset_simplified_data();
 
@@ -69,6 +96,14 @@ namespace trajectory_data_handling {
          */
         static std::vector<unsigned int> db_get_all_trajectory_ids(trajectory_data_handling::db_table table);
 
+        /**
+         * Extracts the IDs of the original trajectories that have not been simplified with the given parameters, or
+         * that have changed since they were.
+         * @param parameters A description of the parameters of the run, as given to insert_simplifications.
+         * @return A list of trajectory IDs in ascending order.
+         */
+        static std::vector<unsigned int> db_get_unsimplified_trajectory_ids(std::string const& parameters);
+
         /**
          * Converts an enum descriptor of a table into a string representation.
          * @param table The enum descriptor of the selected table.
@@ -83,9 +118,14 @@ namespace trajectory_data_handling {
         static std::vector<std::string> get_dates_from_id(int trajectory_id);
     private:
         /**
-         * The connection string that specifies the connection details for the PostgreSQL database.
+         * Streams the points of trajectories into a table with COPY ... FROM STDIN within a transaction.
+         * Duplicate points are removed from original trajectories.
+         * @param trajectories The trajectories to insert.
+         * @param table The table to insert into.
+         * @param txn The transaction to copy in.
          */
-        static std::string connection_string;
+        static void copy_into_transaction(std::span<data_structures::Trajectory const> trajectories, db_table table,
+                                          pqxx::work& txn);
 
         /**
          * Reads a file and executes it in a given transaction on the database.
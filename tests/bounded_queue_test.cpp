@@ -0,0 +1,103 @@
+#include <doctest/doctest.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/concurrency/Bounded_Queue.hpp"
+
+TEST_CASE("Bounded_Queue - Values are popped in the order they are pushed") {
+    concurrency::Bounded_Queue<int> queue{4};
+    CHECK(queue.capacity() == 4);
+    CHECK_FALSE(queue.try_pop().has_value());
+
+    for (int lap = 0; lap < 3; ++lap) {
+        for (int i = 0; i < 4; ++i) {
+            CHECK(queue.try_push(lap * 10 + i));
+        }
+        CHECK(queue.size() == 4);
+        CHECK_FALSE(queue.try_push(99));
+
+        for (int i = 0; i < 4; ++i) {
+            auto value = queue.try_pop();
+            REQUIRE(value.has_value());
+            CHECK(*value == lap * 10 + i);
+        }
+        CHECK(queue.size() == 0);
+        CHECK_FALSE(queue.try_pop().has_value());
+    }
+}
+
+TEST_CASE("Bounded_Queue - Capacity is rounded up to a power of two") {
+    CHECK(concurrency::Bounded_Queue<int>{0}.capacity() == 2);
+    CHECK(concurrency::Bounded_Queue<int>{5}.capacity() == 8);
+    CHECK(concurrency::Bounded_Queue<int>{64}.capacity() == 64);
+}
+
+TEST_CASE("Bounded_Queue - Values are only moved from when they are pushed") {
+    concurrency::Bounded_Queue<std::unique_ptr<std::string>> queue{2};
+    auto first = std::make_unique<std::string>("first");
+    CHECK(queue.try_push(std::move(first)));
+    CHECK(queue.try_push(std::make_unique<std::string>("second")));
+
+    auto rejected = std::make_unique<std::string>("rejected");
+    CHECK_FALSE(queue.try_push(std::move(rejected)));
+    REQUIRE(rejected != nullptr);
+    CHECK(*rejected == "rejected");
+
+    CHECK(**queue.try_pop() == "first");
+}
+
+TEST_CASE("Bounded_Queue - Concurrent producers and consumers transfer every value once") {
+    concurrency::Bounded_Queue<int> queue{16};
+    int const producers = 4;
+    int const consumers = 4;
+    int const values_per_producer = 20000;
+
+    std::vector<std::atomic<int>> received(producers * values_per_producer);
+    std::atomic<int> consumed{0};
+    std::atomic<bool> out_of_order{false};
+
+    std::vector<std::thread> threads{};
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < values_per_producer; ++i) {
+                auto value = p * values_per_producer + i;
+                while (!queue.try_push(std::move(value))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&]() {
+            // The values of one producer reach one consumer in the order they were pushed
+            std::vector<int> last(producers, -1);
+            while (consumed < producers * values_per_producer) {
+                auto value = queue.try_pop();
+                if (!value) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                received[*value]++;
+                consumed++;
+                auto producer = *value / values_per_producer;
+                if (*value <= last[producer]) {
+                    out_of_order = true;
+                }
+                last[producer] = *value;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK_FALSE(out_of_order);
+    int received_once = 0;
+    for (auto& count : received) {
+        received_once += count == 1;
+    }
+    CHECK(received_once == producers * values_per_producer);
+    CHECK(queue.size() == 0);
+}
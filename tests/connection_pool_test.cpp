@@ -0,0 +1,152 @@
+#include <doctest/doctest.h>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../src/database/Basic_Connection_Pool.hpp"
+
+namespace {
+
+    struct Fake_Connection {
+        int id{};
+        bool healthy{true};
+    };
+
+    using Fake_Pool = database::Basic_Connection_Pool<Fake_Connection>;
+
+    /**
+     * Creates a pool whose connections are numbered in the order they are opened.
+     */
+    Fake_Pool make_pool(size_t capacity, std::atomic<int>& connects,
+                        std::chrono::steady_clock::duration health_check_interval = std::chrono::hours(1)) {
+        return Fake_Pool{capacity,
+                         [&connects]() { return std::make_unique<Fake_Connection>(Fake_Connection{++connects}); },
+                         [](Fake_Connection& connection) { return connection.healthy; },
+                         health_check_interval};
+    }
+
+}
+
+TEST_CASE("Connection_Pool - Connections are reused") {
+    std::atomic<int> connects{0};
+    auto pool = make_pool(2, connects);
+    CHECK(pool.open_connections() == 0);
+
+    int first_id{};
+    {
+        auto lease = pool.acquire();
+        first_id = lease->id;
+        CHECK(pool.open_connections() == 1);
+        CHECK(pool.idle_connections() == 0);
+    }
+    CHECK(pool.idle_connections() == 1);
+
+    auto lease = pool.acquire();
+    CHECK(lease->id == first_id);
+    CHECK(connects == 1);
+
+    auto second = pool.acquire();
+    CHECK(second->id != first_id);
+    CHECK(connects == 2);
+}
+
+TEST_CASE("Connection_Pool - Checkouts wait while every connection is leased") {
+    std::atomic<int> connects{0};
+    auto pool = make_pool(1, connects);
+    auto lease = std::optional<Fake_Pool::Lease>{pool.acquire()};
+
+    CHECK_FALSE(pool.try_acquire_for(std::chrono::milliseconds(10)).has_value());
+
+    std::atomic<bool> acquired{false};
+    std::thread waiter{[&pool, &acquired]() {
+        auto other = pool.acquire();
+        acquired = true;
+    }};
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK_FALSE(acquired);
+
+    lease.reset();
+    waiter.join();
+    CHECK(acquired);
+    CHECK(connects == 1);
+    CHECK(pool.try_acquire_for(std::chrono::milliseconds(10)).has_value());
+}
+
+TEST_CASE("Connection_Pool - Concurrent leases never exceed the capacity") {
+    std::atomic<int> connects{0};
+    auto pool = make_pool(3, connects);
+    std::atomic<int> leased{0};
+    std::atomic<int> max_leased{0};
+
+    std::vector<std::thread> threads{};
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 200; ++i) {
+                auto lease = pool.acquire();
+                auto current = ++leased;
+                auto previous = max_leased.load();
+                while (previous < current && !max_leased.compare_exchange_weak(previous, current)) {}
+                leased--;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(max_leased <= 3);
+    CHECK(connects <= 3);
+    CHECK(pool.open_connections() == pool.idle_connections());
+}
+
+TEST_CASE("Connection_Pool - Unhealthy and failed connections are replaced") {
+    SUBCASE("Idle connections that fail the health check are reopened") {
+        std::atomic<int> connects{0};
+        auto pool = make_pool(1, connects, std::chrono::seconds(0));
+        {
+            auto lease = pool.acquire();
+            lease->healthy = false;
+        }
+        auto lease = pool.acquire();
+        CHECK(lease->id == 2);
+        CHECK(pool.open_connections() == 1);
+    }
+
+    SUBCASE("Recently used connections are not checked") {
+        std::atomic<int> connects{0};
+        auto pool = make_pool(1, connects);
+        {
+            auto lease = pool.acquire();
+            lease->healthy = false;
+        }
+        CHECK(pool.acquire()->id == 1);
+    }
+
+    SUBCASE("Connections leased when an exception is thrown are closed") {
+        std::atomic<int> connects{0};
+        auto pool = make_pool(1, connects);
+        CHECK_THROWS([&pool]() {
+            auto lease = pool.acquire();
+            throw std::runtime_error("query failed");
+        }());
+        CHECK(pool.open_connections() == 0);
+        CHECK(pool.acquire()->id == 2);
+    }
+
+    SUBCASE("Discarded connections free their slot") {
+        std::atomic<int> connects{0};
+        auto pool = make_pool(1, connects);
+        auto lease = pool.acquire();
+        lease.discard();
+        CHECK(pool.open_connections() == 0);
+        CHECK(pool.try_acquire_for(std::chrono::milliseconds(10)).has_value());
+    }
+
+    SUBCASE("Failing to connect frees the slot") {
+        auto pool = Fake_Pool{1, []() -> std::unique_ptr<Fake_Connection> { throw std::runtime_error("refused"); }};
+        CHECK_THROWS(pool.acquire());
+        CHECK(pool.open_connections() == 0);
+    }
+}
@@ -0,0 +1,63 @@
+#include <doctest/doctest.h>
+#include <vector>
+#include "../src/data/Flat_Tree.hpp"
+
+class test_flat_tree {
+public:
+    data_structures::Flat_Tree tree{1, 6};
+    test_flat_tree() {
+        init_test_flat_tree();
+    };
+private:
+    void init_test_flat_tree() {
+        tree.add_child(1, 2);
+        tree.add_child(1, 5);
+        tree.add_child(2, 3);
+        tree.add_child(2, 4);
+        tree.add_child(5, 6);
+    }
+};
+
+TEST_CASE("Flat_Tree - Parents are looked up by order") {
+    auto tt = test_flat_tree{};
+
+    SUBCASE("Root has no parent") {
+        CHECK(tt.tree.root() == 1);
+        CHECK(tt.tree.parent(1) == 0);
+    }
+
+    SUBCASE("Children point to their parent") {
+        CHECK(tt.tree.parent(2) == 1);
+        CHECK(tt.tree.parent(3) == 2);
+        CHECK(tt.tree.parent(4) == 2);
+        CHECK(tt.tree.parent(5) == 1);
+        CHECK(tt.tree.parent(6) == 5);
+    }
+}
+
+TEST_CASE("Flat_Tree - Children are returned in insertion order") {
+    auto tt = test_flat_tree{};
+
+    SUBCASE("Inner vertices") {
+        auto root_children = tt.tree.children_of(1);
+        CHECK(std::vector<int>(root_children.begin(), root_children.end()) == std::vector<int>{2, 5});
+        auto children = tt.tree.children_of(2);
+        CHECK(std::vector<int>(children.begin(), children.end()) == std::vector<int>{3, 4});
+    }
+
+    SUBCASE("Leaves have no children") {
+        CHECK(tt.tree.children_of(3).empty());
+        CHECK(tt.tree.children_of(6).empty());
+    }
+
+    SUBCASE("Size counts every vertex") {
+        CHECK(tt.tree.size() == 6);
+    }
+}
+
+TEST_CASE("Flat_Tree - Children of a vertex must be added contiguously") {
+    auto tree = data_structures::Flat_Tree{1, 4};
+    tree.add_child(1, 2);
+    tree.add_child(2, 3);
+    CHECK_THROWS(tree.add_child(1, 4));
+}
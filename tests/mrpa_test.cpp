@@ -1,8 +1,15 @@
 #include "../src/simp-algorithms/MRPA.hpp"
+#include "../src/simp-algorithms/Online_MRPA.hpp"
+#include "../src/simp-algorithms/Segmented_MRPA.hpp"
+#include "../src/simp-algorithms/SED_Oracle.hpp"
+#include "../src/simp-algorithms/PED_Oracle.hpp"
+#include "../src/simp-algorithms/DAD_Oracle.hpp"
 #include "test_trajectories.hpp"
 #include <doctest/doctest.h>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <random>
 
 
 TEST_CASE("MRPA - Check if the order sequence corresponds to integers from 1 to M") {
@@ -176,3 +183,363 @@ TEST_CASE("MRPA - Simplification of a straight line yields only the first and la
         CHECK(tt.compare_locations(res.front().locations.back(), last));
     }
 }
+
+TEST_CASE("MRPA - Independent mode simplifies every level from the original trajectory") {
+    auto tt = test_trajectories();
+    auto cascading = simp_algorithms::MRPA(1.2);
+    auto independent = simp_algorithms::MRPA(1.2, simp_algorithms::MRPA::Mode::independent);
+
+    SUBCASE("The first level is the same in both modes") {
+        auto cascading_res = cascading(tt.gps);
+        auto independent_res = independent(tt.gps);
+
+        REQUIRE(!independent_res.empty());
+        REQUIRE(independent_res.front().size() == cascading_res.front().size());
+        for (int i = 0; i < independent_res.front().size(); ++i) {
+            CHECK(independent_res.front()[i].timestamp == cascading_res.front()[i].timestamp);
+        }
+    }
+
+    SUBCASE("Levels keep the first and last locations and have no neighbouring duplicates") {
+        auto res = independent.run_get_error_tolerances(tt.gps);
+
+        for (int i = 0; i < res.size(); ++i) {
+            auto const& level = res[i].first;
+            CHECK(level.locations.front().timestamp == tt.gps.locations.front().timestamp);
+            CHECK(level.locations.back().timestamp == tt.gps.locations.back().timestamp);
+            if (i > 0) {
+                CHECK(level.size() != res[i - 1].first.size());
+            }
+        }
+    }
+}
+
+TEST_CASE("MRPA - Simplification at a single error tolerance") {
+    auto tt = test_trajectories();
+    auto mrpa = simp_algorithms::MRPA(1.2);
+    auto error_tolerances = mrpa.error_tolerances(tt.gps);
+
+    SUBCASE("Error tolerances are increasing") {
+        REQUIRE(!error_tolerances.empty());
+        for (int i = 1; i < error_tolerances.size(); ++i) {
+            CHECK(error_tolerances[i] > error_tolerances[i - 1]);
+        }
+    }
+
+    SUBCASE("Simplifications keep the first and last locations and are renumbered") {
+        for (auto error_tolerance : {error_tolerances.front(), error_tolerances.back()}) {
+            auto res = mrpa.simplify_at(tt.gps, error_tolerance);
+            CHECK(res.size() <= tt.gps.size());
+            CHECK(res.locations.front().timestamp == tt.gps.locations.front().timestamp);
+            CHECK(res.locations.back().timestamp == tt.gps.locations.back().timestamp);
+            for (int i = 0; i < res.size(); ++i) {
+                CHECK(res[i].order == i + 1);
+            }
+        }
+    }
+
+    SUBCASE("A straight line is simplified to its first and last locations") {
+        auto straight_trajectory = data_structures::Trajectory{};
+        for (int i = 1; i <= 6; ++i) {
+            straight_trajectory.locations.emplace_back(data_structures::Location(i, i - 1, i - 1, i - 1));
+        }
+        auto res = mrpa.simplify_at(straight_trajectory, 0);
+        CHECK(res.size() == 2);
+    }
+}
+
+TEST_CASE("Online_MRPA - Streaming simplification") {
+    auto tt = test_trajectories();
+    auto mrpa = simp_algorithms::MRPA(2);
+    auto error_tolerance = mrpa.error_tolerances(tt.gps)[2];
+
+    auto stream = [](simp_algorithms::Online_MRPA& online, data_structures::Trajectory const& trajectory,
+                     size_t& max_undecided) {
+        std::vector<data_structures::Location> result{};
+        for (auto const& location : trajectory.locations) {
+            auto finalized = online.push(location);
+            result.insert(result.end(), finalized.begin(), finalized.end());
+            max_undecided = std::max(max_undecided, online.undecided_size());
+        }
+        auto finalized = online.finish();
+        result.insert(result.end(), finalized.begin(), finalized.end());
+        return result;
+    };
+
+    // The offline simplification of consecutive segments of window_size locations that share their end locations
+    auto simplify_segments = [&mrpa](data_structures::Trajectory const& trajectory, size_t window_size,
+                                     double tolerance) {
+        std::vector<data_structures::Location> result{trajectory.locations.front()};
+        for (size_t begin = 0; begin + 1 < trajectory.size(); begin += window_size - 1) {
+            auto end = std::min(begin + window_size, trajectory.locations.size());
+            data_structures::Trajectory segment{0, {trajectory.locations.begin() + static_cast<std::ptrdiff_t>(begin),
+                                                    trajectory.locations.begin() + static_cast<std::ptrdiff_t>(end)}};
+            for (int i = 0; i < segment.size(); ++i) {
+                segment[i].order = i + 1;
+            }
+            auto simplified = mrpa.simplify_at(segment, tolerance);
+            result.insert(result.end(), simplified.locations.begin() + 1, simplified.locations.end());
+        }
+        return result;
+    };
+
+    SUBCASE("A window larger than the trajectory gives the offline simplification") {
+        auto online = simp_algorithms::Online_MRPA(error_tolerance, tt.gps.size() + 1);
+        size_t max_undecided{};
+        auto res = stream(online, tt.gps, max_undecided);
+        auto expected = mrpa.simplify_at(tt.gps, error_tolerance);
+
+        REQUIRE(res.size() == expected.size());
+        for (int i = 0; i < res.size(); ++i) {
+            CHECK(tt.compare_locations(res[i], expected[i]));
+        }
+    }
+
+    SUBCASE("The window stays bounded and the locations are finalized in order") {
+        auto online = simp_algorithms::Online_MRPA(error_tolerance, 32);
+        size_t max_undecided{};
+        auto res = stream(online, tt.gps, max_undecided);
+
+        CHECK(max_undecided < 32);
+        CHECK(res.size() < tt.gps.size());
+        CHECK(res.front().timestamp == tt.gps.locations.front().timestamp);
+        CHECK(res.back().timestamp == tt.gps.locations.back().timestamp);
+        for (int i = 0; i < res.size(); ++i) {
+            CHECK(res[i].order == i + 1);
+            if (i > 0) {
+                CHECK(res[i].timestamp > res[i - 1].timestamp);
+            }
+        }
+    }
+
+    SUBCASE("A full window is cut at its newest location") {
+        data_structures::Trajectory line{1, {}};
+        for (int i = 1; i <= 100; ++i) {
+            line.locations.emplace_back(data_structures::Location(i, 1000 + 10 * i, 10 + i * 0.001, 50 + i * 0.001));
+        }
+        auto online = simp_algorithms::Online_MRPA(1e-6, 16);
+        size_t max_undecided{};
+        auto res = stream(online, line, max_undecided);
+        auto expected = simplify_segments(line, 16, 1e-6);
+
+        // The offline simplification keeps the two end locations, and the cuts keep (100 - 2) / 15 more
+        CHECK(mrpa.simplify_at(line, 1e-6).size() == 2);
+        REQUIRE(res.size() == 2 + 6);
+        REQUIRE(res.size() == expected.size());
+        for (int i = 0; i < res.size(); ++i) {
+            CHECK(tt.compare_locations(res[i], expected[i]));
+            CHECK(res[i].timestamp == line[std::min(15 * i, 99)].timestamp);
+        }
+    }
+
+    SUBCASE("A filled window gives the offline simplification of the segments between the cuts") {
+        auto online = simp_algorithms::Online_MRPA(error_tolerance, 16);
+        size_t max_undecided{};
+        auto res = stream(online, tt.gps, max_undecided);
+        auto expected = simplify_segments(tt.gps, 16, error_tolerance);
+
+        CHECK(max_undecided < 16);
+        REQUIRE(res.size() == expected.size());
+        for (int i = 0; i < res.size(); ++i) {
+            CHECK(tt.compare_locations(res[i], expected[i]));
+        }
+
+        // Every pair of consecutive output locations complies with the error tolerance, as it does offline
+        auto oracle = simp_algorithms::SED_Oracle{tt.gps};
+        auto index_of = [&tt](data_structures::Location const& location) {
+            return static_cast<int>(std::ranges::find_if(tt.gps.locations, [&location](auto const& other) {
+                return other.timestamp == location.timestamp;
+            }) - tt.gps.locations.begin()) + 1;
+        };
+        for (int i = 1; i < res.size(); ++i) {
+            CHECK(oracle(index_of(res[i - 1]), index_of(res[i])) <= error_tolerance);
+        }
+    }
+
+    SUBCASE("Locations must arrive in increasing timestamp order") {
+        auto online = simp_algorithms::Online_MRPA(error_tolerance);
+        online.push(tt.gps[1]);
+        CHECK_THROWS(online.push(tt.gps[0]));
+    }
+}
+
+TEST_CASE("Segmented_MRPA - Segments are simplified and stitched together") {
+    auto tt = test_trajectories();
+
+    SUBCASE("The segment size follows the memory ceiling") {
+        auto segmented = simp_algorithms::Segmented_MRPA(1.5, 64 * simp_algorithms::Segmented_MRPA::bytes_per_location);
+        CHECK(segmented.get_segment_size() == 64);
+        auto tiny = simp_algorithms::Segmented_MRPA(1.5, 1);
+        CHECK(tiny.get_segment_size() == simp_algorithms::Segmented_MRPA::min_segment_size);
+    }
+
+    SUBCASE("A trajectory that fits in one segment gives the whole-trajectory simplification") {
+        auto segmented = simp_algorithms::Segmented_MRPA(1.5, 1000 * simp_algorithms::Segmented_MRPA::bytes_per_location);
+        auto res = segmented(tt.gps);
+        auto expected = simp_algorithms::MRPA(1.5)(tt.gps);
+
+        REQUIRE(res.size() == expected.size());
+        for (int i = 0; i < res.size(); ++i) {
+            CHECK(res[i].size() == expected[i].size());
+        }
+    }
+
+    SUBCASE("Stitched levels keep the anchors, the endpoints and a consistent numbering") {
+        auto segmented = simp_algorithms::Segmented_MRPA(1.5, 64 * simp_algorithms::Segmented_MRPA::bytes_per_location);
+        auto res = segmented(tt.gps);
+
+        REQUIRE(!res.empty());
+        for (int l = 0; l < res.size(); ++l) {
+            auto const& level = res[l];
+            CHECK(level.id == tt.gps.id);
+            CHECK(level.locations.front().timestamp == tt.gps.locations.front().timestamp);
+            CHECK(level.locations.back().timestamp == tt.gps.locations.back().timestamp);
+            // The first anchor between segments is the last location of the first segment
+            CHECK(std::ranges::any_of(level.locations, [&](auto const& location) {
+                return location.timestamp == tt.gps[63].timestamp;
+            }));
+            for (int i = 0; i < level.size(); ++i) {
+                CHECK(level[i].order == i + 1);
+                if (i > 0) {
+                    CHECK(level[i].timestamp > level[i - 1].timestamp);
+                }
+            }
+            if (l > 0) {
+                CHECK(level.size() != res[l - 1].size());
+            }
+        }
+    }
+}
+
+TEST_CASE("SED_Oracle - Prefix sum errors match the direct SED error sum") {
+    auto tt = test_trajectories{};
+
+    auto matches_direct_sum = [](data_structures::Trajectory const& trajectory) {
+        auto oracle = simp_algorithms::SED_Oracle{trajectory};
+        auto size = static_cast<int>(trajectory.size());
+        for (int i = 1; i <= size; ++i) {
+            for (int j = i + 1; j <= size; ++j) {
+                auto expected = simp_algorithms::SED_Oracle::direct_sum(trajectory, i, j);
+                if (std::abs(oracle(i, j) - expected) > 1e-6 * expected) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    SUBCASE("N = 18") {
+        CHECK(matches_direct_sum(tt.large));
+    }
+
+    SUBCASE("GPS-like trajectory with epoch timestamps") {
+        CHECK(matches_direct_sum(tt.gps));
+    }
+
+    SUBCASE("Segments at the end of a long trajectory, also without an extended precision long double") {
+        // The steps are taken from the raw generator output, so the trajectory is the same on every platform
+        std::mt19937 gen(1);
+        auto step = [&gen]() { return (static_cast<double>(gen() % 2001) - 1000) * 1e-8; };
+        data_structures::Trajectory walk{1, {}};
+        auto longitude = 116.3;
+        auto latitude = 39.9;
+        unsigned long timestamp = 1201930244;
+        for (int i = 1; i <= 20000; ++i) {
+            longitude += step();
+            latitude += step();
+            timestamp += 1 + gen() % 10;
+            walk.locations.emplace_back(data_structures::Location(i, timestamp, longitude, latitude));
+        }
+
+        auto oracle = simp_algorithms::SED_Oracle{walk};
+        auto accurate = true;
+        for (int i = 19000; i <= 20000; i += 13) {
+            for (int j = i + 20; j <= std::min(20000, i + 200); j += 7) {
+                auto expected = simp_algorithms::SED_Oracle::direct_sum(walk, i, j);
+                accurate = accurate && std::abs(oracle(i, j) - expected) <= 1e-8 * expected;
+            }
+        }
+        CHECK(accurate);
+    }
+
+    SUBCASE("Ranges without interior points have no error") {
+        auto oracle = simp_algorithms::SED_Oracle{tt.large};
+
+        CHECK(oracle(3, 3) == 0);
+        CHECK(oracle(3, 4) == 0);
+        CHECK(oracle(9, 2) == 0);
+    }
+}
+
+TEST_CASE("PED_Oracle and DAD_Oracle - Prefix sum errors match the direct error sums") {
+    auto tt = test_trajectories{};
+
+    auto matches_direct_sum = [](auto const& oracle, auto direct_sum, data_structures::Trajectory const& trajectory) {
+        auto size = static_cast<int>(trajectory.size());
+        bool matches = true;
+        for (int i = 1; i <= size; ++i) {
+            for (int j = i + 1; j <= size; ++j) {
+                auto expected = direct_sum(trajectory, i, j);
+                auto actual = oracle(i, j);
+                matches = matches && std::abs(actual - expected) <= 1e-6 * std::max(expected, 1e-9);
+            }
+        }
+        return matches;
+    };
+
+    SUBCASE("PED") {
+        CHECK(matches_direct_sum(simp_algorithms::PED_Oracle{tt.large}, simp_algorithms::PED_Oracle::direct_sum, tt.large));
+        CHECK(matches_direct_sum(simp_algorithms::PED_Oracle{tt.gps}, simp_algorithms::PED_Oracle::direct_sum, tt.gps));
+    }
+
+    SUBCASE("DAD") {
+        CHECK(matches_direct_sum(simp_algorithms::DAD_Oracle{tt.large}, simp_algorithms::DAD_Oracle::direct_sum, tt.large));
+        CHECK(matches_direct_sum(simp_algorithms::DAD_Oracle{tt.gps}, simp_algorithms::DAD_Oracle::direct_sum, tt.gps));
+    }
+
+    SUBCASE("Ranges without interior points have no error") {
+        CHECK(simp_algorithms::PED_Oracle{tt.gps}(3, 4) == 0);
+        CHECK(simp_algorithms::DAD_Oracle{tt.gps}(3, 4) == 0);
+        CHECK(simp_algorithms::DAD_Oracle{tt.gps}(9, 2) == 0);
+    }
+}
+
+TEST_CASE("MRPA - Every error metric yields valid simplifications") {
+    auto tt = test_trajectories{};
+
+    auto is_valid = [&](auto const& levels) {
+        bool valid = !levels.empty();
+        for (auto const& level : levels) {
+            valid = valid && level.locations.front().timestamp == tt.gps.locations.front().timestamp
+                    && level.locations.back().timestamp == tt.gps.locations.back().timestamp
+                    && level.size() <= tt.gps.size();
+            for (int i = 0; i < level.size(); ++i) {
+                valid = valid && level[i].order == i + 1;
+            }
+        }
+        return valid;
+    };
+
+    CHECK(is_valid(simp_algorithms::MRPA(1.5)(tt.gps)));
+    CHECK(is_valid(simp_algorithms::PED_MRPA(1.5)(tt.gps)));
+    CHECK(is_valid(simp_algorithms::DAD_MRPA(1.5)(tt.gps)));
+}
+
+TEST_CASE("MRPA - Batches are simplified like individual trajectories") {
+    auto tt = test_trajectories{};
+    auto mrpa = simp_algorithms::MRPA(1.5);
+    std::vector<data_structures::Trajectory> batch{tt.small, tt.gps, tt.large, tt.gps};
+
+    auto result = mrpa.simplify_all(batch);
+
+    REQUIRE(result.size() == batch.size());
+    for (int i = 0; i < batch.size(); ++i) {
+        auto expected = mrpa(batch[i]);
+        REQUIRE(result[i].simplifications.size() == expected.size());
+        for (int level = 0; level < expected.size(); ++level) {
+            CHECK(result[i].simplifications[level].locations == expected[level].locations);
+        }
+        CHECK(result[i].elapsed.count() >= 0);
+    }
+    CHECK(mrpa.simplify_all({}).empty());
+}
@@ -0,0 +1,51 @@
+#include <doctest/doctest.h>
+#include "../src/data/Order_Frontier.hpp"
+
+TEST_CASE("Order_Frontier - Next finds the smallest remaining order") {
+    auto frontier = data_structures::Order_Frontier{2, 8};
+
+    SUBCASE("Every order remains initially") {
+        CHECK(frontier.size() == 7);
+        CHECK(frontier.next(1) == 2);
+        CHECK(frontier.next(5) == 5);
+        CHECK(frontier.next(9) == frontier.end());
+    }
+
+    SUBCASE("Removed orders are skipped") {
+        frontier.erase(4);
+        frontier.erase(5);
+        frontier.erase(3);
+        CHECK(frontier.next(3) == 6);
+        CHECK(frontier.next(2) == 2);
+        CHECK(frontier.size() == 4);
+    }
+
+    SUBCASE("Removing the last orders reaches the end") {
+        frontier.erase(8);
+        frontier.erase(7);
+        CHECK(frontier.next(7) == frontier.end());
+        CHECK(frontier.next(6) == 6);
+    }
+}
+
+TEST_CASE("Order_Frontier - Removal") {
+    auto frontier = data_structures::Order_Frontier{1, 3};
+
+    SUBCASE("Removing an order twice only counts once") {
+        frontier.erase(2);
+        frontier.erase(2);
+        CHECK(frontier.size() == 2);
+    }
+
+    SUBCASE("Removing every order empties the set") {
+        frontier.erase(1);
+        frontier.erase(3);
+        frontier.erase(2);
+        CHECK(frontier.empty());
+        CHECK(frontier.next(1) == frontier.end());
+    }
+
+    SUBCASE("An empty range creates an empty set") {
+        CHECK(data_structures::Order_Frontier{2, 1}.empty());
+    }
+}
@@ -1,6 +1,16 @@
 #include <doctest/doctest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <tuple>
 #include "test_trajectories.hpp"
 #include "../src/querying/Range_Query_Test.hpp"
+#include "../src/querying/KNN_Index.hpp"
+#include "../src/querying/KNN_Query.hpp"
+#include "../src/querying/KNN_Query_Test.hpp"
+#include "../src/querying/Query_Evaluator.hpp"
+#include "../src/simp-algorithms/MRPA.hpp"
 
 TEST_CASE("Range_Query - operator()") {
     auto trajectories = test_trajectories{};
@@ -31,3 +41,399 @@ TEST_CASE("Range_Query - operator()") {
     }
 
 }
+
+TEST_CASE("Range_Query - Batch evaluation matches per-window evaluation") {
+    auto trajectories = test_trajectories{};
+    auto const& gps = trajectories.gps;
+
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> longitude(116.28, 116.32);
+    std::uniform_real_distribution<double> latitude(39.88, 39.92);
+    std::uniform_real_distribution<double> extent(0, 0.01);
+    std::uniform_int_distribution<unsigned long> timestamp(gps.locations.front().timestamp - 1000,
+                                                           gps.locations.back().timestamp + 1000);
+
+    std::vector<spatial_queries::Range_Query::Window> windows{};
+    for (int i = 0; i < 500; ++i) {
+        auto x = longitude(gen);
+        auto y = latitude(gen);
+        auto t = timestamp(gen);
+        auto half_x = extent(gen);
+        auto half_y = extent(gen);
+        windows.push_back({x - half_x, x + half_x, y - half_y, y + half_y, t, t + 20000});
+    }
+    // Windows on a single location and unbounded windows
+    windows.push_back({gps[10].longitude, gps[10].longitude, gps[10].latitude, gps[10].latitude,
+                       gps[10].timestamp, gps[10].timestamp});
+    windows.emplace_back();
+    windows.push_back({0, 1, 0, 1, 0, 1});
+
+    auto in_windows = spatial_queries::Range_Query::in_range_batch(gps, windows);
+    REQUIRE(in_windows.size() == windows.size());
+    int hits = 0;
+    for (size_t i = 0; i < windows.size(); ++i) {
+        CHECK(in_windows[i] == spatial_queries::Range_Query::in_range(gps, windows[i]));
+        hits += in_windows[i];
+    }
+    CHECK(hits > 0);
+    CHECK(hits < static_cast<int>(windows.size()));
+
+    auto locations = spatial_queries::Range_Query::find_in_range_batch(gps, windows);
+    for (size_t i = 0; i < windows.size(); ++i) {
+        CHECK((locations[i] != spatial_queries::Range_Query::no_location) == in_windows[i]);
+        if (in_windows[i]) {
+            CHECK(spatial_queries::Range_Query::contains(windows[i], gps[locations[i]]));
+        }
+    }
+
+    // Locations that are not in time order are swept in time order
+    auto reversed = gps;
+    std::ranges::reverse(reversed.locations);
+    CHECK(spatial_queries::Range_Query::in_range_batch(reversed, windows) == in_windows);
+
+    CHECK(spatial_queries::Range_Query::in_range_batch(data_structures::Trajectory{}, windows)
+          == std::vector<bool>(windows.size(), false));
+}
+
+namespace {
+
+    /**
+     * Answers a KNN query like the SQL query in KNN_Query, by computing the distance of every trajectory.
+     */
+    std::vector<spatial_queries::KNN_Query::KNN_Result_Element> brute_force_knn(
+            std::vector<data_structures::Trajectory> const& trajectories, int k,
+            spatial_queries::KNN_Query::KNN_Origin const& origin) {
+        std::vector<spatial_queries::KNN_Query::KNN_Result_Element> result{};
+        for (auto const& trajectory : trajectories) {
+            auto nearest = std::numeric_limits<double>::infinity();
+            for (auto const& location : trajectory.locations) {
+                if (location.timestamp >= origin.t_low && location.timestamp <= origin.t_high) {
+                    auto dx = location.longitude - origin.x;
+                    auto dy = location.latitude - origin.y;
+                    nearest = std::min(nearest, std::sqrt(dx * dx + dy * dy));
+                }
+            }
+            if (!std::isinf(nearest)) {
+                result.push_back({trajectory.id, nearest});
+            }
+        }
+        std::ranges::sort(result, {}, [](auto const& element) { return std::tie(element.distance, element.id); });
+        result.resize(std::min(result.size(), static_cast<size_t>(k)));
+        return result;
+    }
+
+}
+
+TEST_CASE("KNN_Index - Results match a brute force KNN query") {
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<double> start(116.0, 116.8);
+    std::uniform_real_distribution<double> step(-0.002, 0.002);
+    std::uniform_int_distribution<unsigned long> interval(1, 120);
+    std::uniform_int_distribution<int> length(1, 400);
+
+    std::vector<data_structures::Trajectory> trajectories{};
+    for (unsigned int id = 1; id <= 200; ++id) {
+        data_structures::Trajectory trajectory{id, {}};
+        auto longitude = start(gen);
+        auto latitude = start(gen) - 76.5;
+        unsigned long timestamp = 1201930000 + interval(gen) * 100;
+        auto size = length(gen);
+        for (int i = 1; i <= size; ++i) {
+            trajectory.locations.emplace_back(data_structures::Location(i, timestamp, longitude, latitude));
+            longitude += step(gen);
+            latitude += step(gen);
+            timestamp += interval(gen);
+        }
+        trajectories.push_back(trajectory);
+    }
+    // Locations out of time order and an empty trajectory are indexed as well
+    std::ranges::reverse(trajectories[3].locations);
+    trajectories.push_back(data_structures::Trajectory{201, {}});
+
+    auto index = spatial_queries::KNN_Index{trajectories};
+    CHECK(index.size() == 200);
+
+    std::uniform_real_distribution<double> x(115.9, 116.9);
+    std::uniform_real_distribution<double> y(39.4, 40.4);
+    std::uniform_int_distribution<unsigned long> t(1201930000, 1201930000 + 30000);
+    for (int query = 0; query < 300; ++query) {
+        spatial_queries::KNN_Query::KNN_Origin origin{x(gen), y(gen)};
+        if (query % 3 != 0) {
+            origin.t_low = t(gen);
+            origin.t_high = origin.t_low + (query % 3 == 1 ? 600 : 10000);
+        }
+        for (int k : {1, 4, 11}) {
+            auto expected = brute_force_knn(trajectories, k, origin);
+            auto actual = index.get_ids_from_knn(k, origin);
+            REQUIRE(actual.size() == expected.size());
+            for (size_t i = 0; i < actual.size(); ++i) {
+                CHECK(actual[i].id == expected[i].id);
+                CHECK(actual[i].distance == expected[i].distance);
+            }
+        }
+    }
+
+    CHECK(index.get_ids_from_knn(0, {116.4, 39.9}).empty());
+    CHECK(index.get_ids_from_knn(3, {116.4, 39.9, 0, 1}).empty());
+}
+
+TEST_CASE("KNN_Query - Batch statement contains every origin") {
+    std::vector<spatial_queries::KNN_Query::KNN_Origin> origins{{116.5, 39.9, 1201930000, 1201940000},
+                                                                {116.25, 40.125}};
+    auto query = spatial_queries::KNN_Query::create_knn_batch_query("original_trajectories", 4, origins);
+
+    CHECK(query.find("(0, 116.5::float8, 39.899999999999999::float8, 1201930000::bigint, 1201940000::bigint)")
+          != std::string::npos);
+    // Unbounded time intervals are clamped to the range of the time column
+    CHECK(query.find("(1, 116.25::float8, 40.125::float8, 0::bigint, 9223372036854775807::bigint)")
+          != std::string::npos);
+    CHECK(query.find("FROM original_trajectories") != std::string::npos);
+    CHECK(query.find("LIMIT 4") != std::string::npos);
+}
+
+TEST_CASE("Query_Evaluator - F1 bounds") {
+    using spatial_queries::Query_Evaluator;
+    CHECK(Query_Evaluator::f1(10, 10) == 1);
+    CHECK(Query_Evaluator::f1(0, 10) == 0);
+    CHECK(Query_Evaluator::f1(5, 10) == doctest::Approx(2.0 / 3));
+
+    auto bounds = Query_Evaluator::f1_bounds(3, 2, 10);
+    CHECK(bounds.lower == Query_Evaluator::f1(3, 10));
+    CHECK(bounds.upper == Query_Evaluator::f1(8, 10));
+
+    bounds = Query_Evaluator::f1_bounds(6, 4, 10);
+    CHECK(bounds.lower == bounds.upper);
+}
+
+TEST_CASE("Query_Evaluator - Early exit decides like a full evaluation") {
+    auto trajectories = test_trajectories{};
+    auto gps = trajectories.gps;
+    gps.id = 1;
+
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<size_t> location(0, gps.size() - 1);
+    std::uniform_real_distribution<double> extent(0.0005, 0.01);
+    std::uniform_int_distribution<unsigned long> duration(0, 20000);
+
+    // Windows around locations of the original, and KNN queries among shifted copies of it
+    std::vector<std::shared_ptr<spatial_queries::Query>> query_objects{};
+    for (int i = 0; i < 400; ++i) {
+        auto const& loc = gps[location(gen)];
+        auto half_x = extent(gen);
+        auto half_y = extent(gen);
+        auto half_t = duration(gen);
+        query_objects.push_back(std::make_shared<spatial_queries::Range_Query_Test>(
+                gps, loc.longitude - half_x, loc.longitude + half_x, loc.latitude - half_y, loc.latitude + half_y,
+                loc.timestamp - half_t, loc.timestamp + half_t));
+    }
+    std::vector<data_structures::Trajectory> originals{gps};
+    for (unsigned int id = 2; id <= 5; ++id) {
+        auto copy = gps;
+        copy.id = id;
+        for (auto& loc : copy.locations) {
+            loc.longitude += 0.002 * id;
+        }
+        originals.push_back(copy);
+    }
+    auto index = spatial_queries::KNN_Index{originals};
+    for (int i = 0; i < 200; ++i) {
+        auto const& loc = gps[location(gen)];
+        spatial_queries::KNN_Query::KNN_Origin origin{loc.longitude + extent(gen), loc.latitude - extent(gen),
+                                                      loc.timestamp - duration(gen), loc.timestamp + duration(gen)};
+        auto test = std::make_shared<spatial_queries::KNN_Query_Test>(gps.id, 2, origin,
+                                                                       index.get_ids_from_knn(3, origin));
+        if (test->original_in_result) {
+            query_objects.push_back(test);
+        }
+    }
+
+    std::vector<data_structures::Trajectory> candidates{};
+    for (size_t step : {128, 32, 8, 2, 1}) {
+        data_structures::Trajectory candidate{gps.id, {}};
+        for (size_t i = 0; i < gps.size(); i += step) {
+            candidate.locations.push_back(gps[i]);
+        }
+        candidates.push_back(candidate);
+    }
+
+    for (bool use_knn : {false, true}) {
+        spatial_queries::Query_Evaluator full{query_objects, use_knn};
+        spatial_queries::Query_Evaluator early{query_objects, use_knn};
+        for (double min_range_f1 : {0.0, 0.5, 0.8, 0.95, 1.0}) {
+            for (double min_knn_f1 : {0.0, 0.6, 0.9}) {
+                for (auto const& candidate : candidates) {
+                    auto accuracy = full.accuracy(candidate);
+                    auto expected = accuracy.range_f1 >= min_range_f1 && accuracy.knn_f1 >= min_knn_f1;
+                    CHECK(early.accepts(candidate, min_range_f1, min_knn_f1) == expected);
+                }
+            }
+        }
+        CHECK(early.evaluated_tests() < full.evaluated_tests());
+    }
+
+    // The coarsest candidate fails as soon as one chunk of tests has missed enough
+    spatial_queries::Query_Evaluator evaluator{query_objects, true};
+    CHECK(evaluator.accuracy(candidates.front()).range_f1 < 0.6);
+    auto evaluated = evaluator.evaluated_tests();
+    CHECK_FALSE(evaluator.accepts(candidates.front(), 0.95, 0.9));
+    CHECK(evaluator.evaluated_tests() - evaluated < 100);
+    CHECK(evaluator.accepts(candidates.back(), 1.0, 1.0));
+
+    // Without tests, the F1-score is undefined and nothing is accepted
+    spatial_queries::Query_Evaluator empty{{}, false};
+    CHECK_FALSE(empty.accepts(gps, 0, 0));
+}
+
+TEST_CASE("Query_Evaluator - Incremental evaluation matches a full evaluation") {
+    auto trajectories = test_trajectories{};
+    auto gps = trajectories.gps;
+    gps.id = 1;
+
+    std::mt19937 gen(13);
+    std::uniform_int_distribution<size_t> location(0, gps.size() - 1);
+    std::uniform_real_distribution<double> extent(0.0005, 0.01);
+    std::uniform_int_distribution<unsigned long> duration(0, 20000);
+
+    std::vector<std::shared_ptr<spatial_queries::Query>> query_objects{};
+    for (int i = 0; i < 300; ++i) {
+        auto const& loc = gps[location(gen)];
+        auto half_x = extent(gen);
+        auto half_y = extent(gen);
+        auto half_t = duration(gen);
+        // Windows beside the original, which are correct while the simplification stays out of them as well
+        auto shift = i % 10 == 0 ? 1.0 : 0.0;
+        query_objects.push_back(std::make_shared<spatial_queries::Range_Query_Test>(
+                gps, loc.longitude - half_x + shift, loc.longitude + half_x + shift, loc.latitude - half_y,
+                loc.latitude + half_y, loc.timestamp - half_t, loc.timestamp + half_t));
+    }
+    std::vector<data_structures::Trajectory> originals{gps};
+    for (unsigned int id = 2; id <= 4; ++id) {
+        auto copy = gps;
+        copy.id = id;
+        for (auto& loc : copy.locations) {
+            loc.latitude += 0.003 * id;
+        }
+        originals.push_back(copy);
+    }
+    auto index = spatial_queries::KNN_Index{originals};
+    for (int i = 0; i < 150; ++i) {
+        auto const& loc = gps[location(gen)];
+        spatial_queries::KNN_Query::KNN_Origin origin{loc.longitude - extent(gen), loc.latitude + extent(gen)};
+        if (i % 2 == 0) {
+            origin.t_low = loc.timestamp - duration(gen);
+            origin.t_high = loc.timestamp + duration(gen);
+        }
+        auto test = std::make_shared<spatial_queries::KNN_Query_Test>(gps.id, 1 + i % 3, origin,
+                                                                       index.get_ids_from_knn(2 + i % 3, origin));
+        if (test->original_in_result) {
+            query_objects.push_back(test);
+        }
+    }
+
+    spatial_queries::Query_Evaluator full{query_objects, true};
+    spatial_queries::Query_Evaluator incremental{gps, query_objects, true};
+
+    // Random subsets of the original locations, from coarse to fine and back, and in no particular order
+    std::vector<data_structures::Trajectory> candidates{};
+    for (double keep : {0.01, 0.05, 0.2, 0.5, 0.9, 1.0, 0.3, 0.02, 0.7}) {
+        std::bernoulli_distribution kept(keep);
+        data_structures::Trajectory candidate{gps.id, {}};
+        for (auto const& loc : gps.locations) {
+            if (kept(gen)) {
+                candidate.locations.push_back(loc);
+            }
+        }
+        candidates.push_back(candidate);
+    }
+    candidates.push_back(data_structures::Trajectory{gps.id, {}});
+    auto duplicates = candidates[2];
+    duplicates.locations.insert(duplicates.locations.end(), candidates[3].locations.begin(),
+                                candidates[3].locations.end());
+    candidates.push_back(duplicates);
+
+    for (auto const& candidate : candidates) {
+        auto expected = full.accuracy(candidate);
+        auto actual = incremental.accuracy(candidate);
+        CHECK(actual.range_f1 == expected.range_f1);
+        CHECK(actual.knn_f1 == expected.knn_f1);
+        CHECK(incremental.accepts(candidate, 0.8, 0.8) == (expected.range_f1 >= 0.8 && expected.knn_f1 >= 0.8));
+    }
+    CHECK(incremental.evaluated_tests() == 0);
+    CHECK(incremental.updated_tests() > 0);
+
+    // A candidate with locations that are not in the original trajectory is evaluated in full
+    auto updated = incremental.updated_tests();
+    auto moved = candidates[4];
+    moved.locations[moved.size() / 2].longitude += 0.001;
+    auto expected = full.accuracy(moved);
+    auto actual = incremental.accuracy(moved);
+    CHECK(actual.range_f1 == expected.range_f1);
+    CHECK(actual.knn_f1 == expected.knn_f1);
+    CHECK(incremental.evaluated_tests() == static_cast<long>(query_objects.size()));
+    CHECK(incremental.updated_tests() == updated);
+
+    // The incremental state is unaffected by it
+    actual = incremental.accuracy(candidates[1]);
+    CHECK(actual.range_f1 == full.accuracy(candidates[1]).range_f1);
+    CHECK(actual.knn_f1 == full.accuracy(candidates[1]).knn_f1);
+}
+
+TEST_CASE("Query_Evaluator - MRPA levels are evaluated incrementally") {
+    auto trajectories = test_trajectories{};
+    auto gps = trajectories.gps;
+    gps.id = 1;
+
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<size_t> location(0, gps.size() - 1);
+    std::uniform_real_distribution<double> extent(0.0005, 0.01);
+    std::uniform_int_distribution<unsigned long> duration(0, 20000);
+
+    std::vector<std::shared_ptr<spatial_queries::Query>> query_objects{};
+    for (int i = 0; i < 300; ++i) {
+        auto const& loc = gps[location(gen)];
+        auto half_x = extent(gen);
+        auto half_y = extent(gen);
+        auto half_t = duration(gen);
+        query_objects.push_back(std::make_shared<spatial_queries::Range_Query_Test>(
+                gps, loc.longitude - half_x, loc.longitude + half_x, loc.latitude - half_y, loc.latitude + half_y,
+                loc.timestamp - half_t, loc.timestamp + half_t));
+    }
+    std::vector<data_structures::Trajectory> originals{gps};
+    for (unsigned int id = 2; id <= 4; ++id) {
+        auto copy = gps;
+        copy.id = id;
+        for (auto& loc : copy.locations) {
+            loc.longitude += 0.002 * id;
+        }
+        originals.push_back(copy);
+    }
+    auto index = spatial_queries::KNN_Index{originals};
+    for (int i = 0; i < 150; ++i) {
+        auto const& loc = gps[location(gen)];
+        spatial_queries::KNN_Query::KNN_Origin origin{loc.longitude - extent(gen), loc.latitude + extent(gen),
+                                                      loc.timestamp - duration(gen), loc.timestamp + duration(gen)};
+        auto test = std::make_shared<spatial_queries::KNN_Query_Test>(gps.id, 2, origin,
+                                                                       index.get_ids_from_knn(3, origin));
+        if (test->original_in_result) {
+            query_objects.push_back(test);
+        }
+    }
+
+    for (auto mode : {simp_algorithms::MRPA_Mode::cascading, simp_algorithms::MRPA_Mode::independent}) {
+        // MRPA renumbers the orders of every level, so the levels are matched to the original by their locations
+        auto levels = simp_algorithms::MRPA{2, mode}(gps);
+        REQUIRE(levels.size() > 2);
+        CHECK(levels.front()[1].order == 2);
+
+        spatial_queries::Query_Evaluator full{query_objects, true};
+        spatial_queries::Query_Evaluator incremental{gps, query_objects, true};
+        for (int i = static_cast<int>(levels.size()) - 1; i >= 0; --i) {
+            auto expected = full.accuracy(levels[i]);
+            auto actual = incremental.accuracy(levels[i]);
+            CHECK(actual.range_f1 == expected.range_f1);
+            CHECK(actual.knn_f1 == expected.knn_f1);
+        }
+        CHECK(incremental.evaluated_tests() == 0);
+        CHECK(incremental.updated_tests() > 0);
+    }
+}
@@ -0,0 +1,101 @@
+#include <doctest/doctest.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../src/simp-algorithms/Run_Metrics.hpp"
+
+using trace_q::Run_Metrics;
+using namespace std::chrono_literals;
+
+TEST_CASE("Run_Metrics - Trajectories are added up per stage") {
+    Run_Metrics metrics{};
+    metrics.start(3);
+
+    metrics.add_trajectory({10ms, 20ms, 30ms, 100, 40, 7, 2, 4});
+    metrics.add_trajectory({30ms, 20ms, 10ms, 50, 10, 5, 1, 0});
+    metrics.add_trajectory({0ms, 0ms, 0ms, 0, 0, 0, 0, std::nullopt});
+    metrics.add_stage_time(Run_Metrics::Stage::load, 5ms);
+    metrics.add_stage_time(Run_Metrics::Stage::insert, 7ms);
+
+    auto snapshot = metrics.snapshot();
+    CHECK(snapshot.running);
+    CHECK(snapshot.trajectories == 3);
+    CHECK(snapshot.trajectories_simplified == 3);
+    CHECK(snapshot.trajectories_kept == 1);
+    CHECK(snapshot.query_objects_generated == 150);
+    CHECK(snapshot.query_tests_evaluated == 50);
+    CHECK(snapshot.query_tests_updated == 12);
+    CHECK(snapshot.levels_tried == 3);
+    CHECK(snapshot.chosen_levels == std::vector<uint64_t>{1, 0, 0, 0, 1});
+
+    auto const& candidate_generation = snapshot.stages[static_cast<size_t>(Run_Metrics::Stage::candidate_generation)];
+    CHECK(candidate_generation.total_seconds == doctest::Approx(0.04));
+    CHECK(candidate_generation.mean_seconds_per_trajectory == doctest::Approx(0.04 / 3));
+    CHECK(candidate_generation.max_seconds == doctest::Approx(0.03));
+    CHECK(snapshot.stages[static_cast<size_t>(Run_Metrics::Stage::query_evaluation)].max_seconds
+          == doctest::Approx(0.03));
+    CHECK(snapshot.stages[static_cast<size_t>(Run_Metrics::Stage::load)].total_seconds == doctest::Approx(0.005));
+    CHECK(snapshot.stages[static_cast<size_t>(Run_Metrics::Stage::insert)].total_seconds == doctest::Approx(0.007));
+
+    metrics.finish();
+    auto finished = metrics.snapshot();
+    CHECK_FALSE(finished.running);
+    CHECK(metrics.snapshot().elapsed_seconds == finished.elapsed_seconds);
+}
+
+TEST_CASE("Run_Metrics - Starting a run resets the counters") {
+    Run_Metrics metrics{};
+    CHECK_FALSE(metrics.snapshot().running);
+    CHECK(metrics.snapshot().elapsed_seconds == 0);
+
+    metrics.start(1);
+    metrics.add_trajectory({1ms, 1ms, 1ms, 10, 10, 10, 1, Run_Metrics::max_levels + 5});
+    CHECK(metrics.snapshot().chosen_levels.size() == Run_Metrics::max_levels);
+    metrics.finish();
+
+    metrics.start(2);
+    auto snapshot = metrics.snapshot();
+    CHECK(snapshot.trajectories == 2);
+    CHECK(snapshot.trajectories_simplified == 0);
+    CHECK(snapshot.query_objects_generated == 0);
+    CHECK(snapshot.query_tests_updated == 0);
+    CHECK(snapshot.chosen_levels.empty());
+    for (auto const& stage : snapshot.stages) {
+        CHECK(stage.total_seconds == 0);
+        CHECK(stage.max_seconds == 0);
+    }
+}
+
+TEST_CASE("Run_Metrics - Concurrent trajectories are all counted") {
+    Run_Metrics metrics{};
+    metrics.start(4000);
+
+    std::vector<std::thread> threads{};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&metrics, t]() {
+            for (int i = 0; i < 1000; ++i) {
+                metrics.add_trajectory({1us, 1us, std::chrono::microseconds(t), 2, 3, 4, 1,
+                                        static_cast<size_t>(t)});
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto snapshot = metrics.snapshot();
+    CHECK(snapshot.trajectories_simplified == 4000);
+    CHECK(snapshot.query_objects_generated == 8000);
+    CHECK(snapshot.query_tests_evaluated == 12000);
+    CHECK(snapshot.query_tests_updated == 16000);
+    CHECK(snapshot.chosen_levels == std::vector<uint64_t>{1000, 1000, 1000, 1000});
+    CHECK(snapshot.stages[static_cast<size_t>(Run_Metrics::Stage::candidate_generation)].total_seconds
+          == doctest::Approx(0.004));
+    CHECK(snapshot.stages[static_cast<size_t>(Run_Metrics::Stage::query_evaluation)].max_seconds
+          == doctest::Approx(0.000003));
+}
+
+TEST_CASE("Run_Metrics - Stages are named") {
+    CHECK(Run_Metrics::stage_name(Run_Metrics::Stage::candidate_generation) == "candidate_generation");
+    CHECK(Run_Metrics::stage_name(Run_Metrics::Stage::insert) == "insert");
+}
@@ -0,0 +1,140 @@
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../src/simp-algorithms/Simplification_Pipeline.hpp"
+
+namespace {
+
+    using trace_q::Simplification_Pipeline;
+    using data_structures::Trajectory;
+
+    /**
+     * Loads a trajectory with id + 1 locations for every ID.
+     */
+    std::vector<Trajectory> load(std::vector<unsigned int> const& ids) {
+        std::vector<Trajectory> result{};
+        for (auto id : ids) {
+            Trajectory trajectory{id, {}};
+            for (unsigned int i = 0; i <= id; ++i) {
+                trajectory.locations.push_back(data_structures::Location{static_cast<int>(i), i, 0, 0});
+            }
+            result.push_back(trajectory);
+        }
+        return result;
+    }
+
+    /**
+     * Keeps the first and last location.
+     */
+    Trajectory simplify(Trajectory const& trajectory) {
+        return Trajectory{trajectory.id, {trajectory.locations.front(), trajectory.locations.back()}};
+    }
+
+    std::vector<unsigned int> make_ids(unsigned int count) {
+        std::vector<unsigned int> ids(count);
+        for (unsigned int i = 0; i < count; ++i) {
+            ids[i] = i + 1;
+        }
+        return ids;
+    }
+
+}
+
+TEST_CASE("Simplification_Pipeline - Every trajectory is simplified and written once") {
+    std::mutex mutex{};
+    std::vector<Trajectory> written{};
+    size_t largest_batch = 0;
+    auto write = [&](std::vector<Trajectory> const& batch) {
+        std::scoped_lock lock{mutex};
+        largest_batch = std::max(largest_batch, batch.size());
+        written.insert(written.end(), batch.begin(), batch.end());
+    };
+
+    auto ids = make_ids(500);
+    Simplification_Pipeline pipeline{load, simplify, write, {16, 8, 4}};
+    auto stats = pipeline.run(ids);
+
+    REQUIRE(written.size() == ids.size());
+    std::ranges::sort(written, {}, &Trajectory::id);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        CHECK(written[i].id == ids[i]);
+        CHECK(written[i].size() == 2);
+        CHECK(written[i].locations.back().timestamp == ids[i]);
+    }
+    CHECK(largest_batch <= 16);
+
+    CHECK(stats.load.trajectories == 500);
+    CHECK(stats.simplify.trajectories == 500);
+    CHECK(stats.write.trajectories == 500);
+    CHECK(stats.loaded.capacity == 8);
+    CHECK(stats.loaded.max_depth <= 8);
+    CHECK(stats.loaded.max_depth >= 1);
+    CHECK(stats.simplified.max_depth <= 8);
+    CHECK(stats.seconds > 0);
+    CHECK(stats.to_string().find("500 trajectories") != std::string::npos);
+
+    SUBCASE("Nothing is loaded without IDs") {
+        auto empty = pipeline.run({});
+        CHECK(empty.write.trajectories == 0);
+    }
+}
+
+TEST_CASE("Simplification_Pipeline - A slow trajectory does not hold back the others") {
+    std::atomic<bool> slow_done{false};
+    std::atomic<int> written_before_slow{0};
+    auto slow_simplify = [&](Trajectory const& trajectory) {
+        if (trajectory.id == 1) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            slow_done = true;
+        }
+        return simplify(trajectory);
+    };
+    auto write = [&](std::vector<Trajectory> const& batch) {
+        if (!slow_done) {
+            written_before_slow += static_cast<int>(batch.size());
+        }
+    };
+
+    Simplification_Pipeline pipeline{load, slow_simplify, write, {4, 8, 2}};
+    auto stats = pipeline.run(make_ids(50));
+    CHECK(stats.write.trajectories == 50);
+    CHECK(written_before_slow == 49);
+}
+
+TEST_CASE("Simplification_Pipeline - The first exception of a stage is rethrown") {
+    auto ids = make_ids(200);
+    auto write = [](std::vector<Trajectory> const&) {};
+
+    SUBCASE("Simplification") {
+        auto failing_simplify = [](Trajectory const& trajectory) {
+            if (trajectory.id == 42) {
+                throw std::runtime_error("simplification failed");
+            }
+            return simplify(trajectory);
+        };
+        Simplification_Pipeline pipeline{load, failing_simplify, write, {8, 4, 3}};
+        CHECK_THROWS_AS(pipeline.run(ids), std::runtime_error);
+    }
+
+    SUBCASE("Loading") {
+        auto failing_load = [](std::vector<unsigned int> const& batch_ids) -> std::vector<Trajectory> {
+            if (batch_ids.front() > 100) {
+                throw std::runtime_error("connection lost");
+            }
+            return load(batch_ids);
+        };
+        Simplification_Pipeline pipeline{failing_load, simplify, write, {8, 4, 3}};
+        CHECK_THROWS_AS(pipeline.run(ids), std::runtime_error);
+    }
+
+    SUBCASE("Writing") {
+        auto failing_write = [](std::vector<Trajectory> const&) { throw std::runtime_error("disk full"); };
+        Simplification_Pipeline pipeline{load, simplify, failing_write, {8, 4, 3}};
+        CHECK_THROWS_AS(pipeline.run(ids), std::runtime_error);
+    }
+}
@@ -0,0 +1,135 @@
+#include "../src/simp-algorithms/Simplification_Levels.hpp"
+#include "../src/simp-algorithms/TD_TR.hpp"
+#include "../src/simp-algorithms/SQUISH_E.hpp"
+#include "../src/simp-algorithms/OPW.hpp"
+#include "test_trajectories.hpp"
+#include <doctest/doctest.h>
+#include <cmath>
+
+namespace {
+
+    /**
+     * Checks that the levels decrease in size, keep the endpoints, are subsequences of the original trajectory and
+     * are numbered from 1.
+     */
+    bool is_valid(std::vector<data_structures::Trajectory> const& levels, data_structures::Trajectory const& original) {
+        bool valid = true;
+        size_t previous_size = original.size() + 1;
+        for (auto const& level : levels) {
+            valid = valid && level.size() >= 2 && level.size() < previous_size
+                    && level.locations.front().timestamp == original.locations.front().timestamp
+                    && level.locations.back().timestamp == original.locations.back().timestamp;
+            previous_size = level.size();
+
+            size_t position = 0;
+            for (int i = 0; i < level.size(); ++i) {
+                valid = valid && level[i].order == i + 1;
+                while (position < original.size() && original[position].timestamp != level[i].timestamp) {
+                    position++;
+                }
+                valid = valid && position < original.size();
+            }
+        }
+        return valid;
+    }
+
+    /**
+     * Checks that every level only keeps locations that the previous level keeps.
+     */
+    bool is_nested(std::vector<data_structures::Trajectory> const& levels) {
+        bool nested = true;
+        for (size_t level = 1; level < levels.size(); ++level) {
+            size_t position = 0;
+            for (auto const& location : levels[level].locations) {
+                while (position < levels[level - 1].size()
+                       && levels[level - 1][position].timestamp != location.timestamp) {
+                    position++;
+                }
+                nested = nested && position < levels[level - 1].size();
+            }
+        }
+        return nested;
+    }
+
+    /**
+     * The largest synchronized Euclidean distance of a removed location to the segment of the simplification
+     * that covers it.
+     */
+    double largest_distance(data_structures::Trajectory const& original, data_structures::Trajectory const& simplified) {
+        double result{};
+        size_t segment = 0;
+        for (auto const& location : original.locations) {
+            while (simplified[segment + 1].timestamp < location.timestamp) {
+                segment++;
+            }
+            result = std::max(result, simp_algorithms::Simplification_Levels::synchronized_distance(
+                    simplified[segment], location, simplified[segment + 1]));
+        }
+        return result;
+    }
+
+}
+
+TEST_CASE("Simplification_Levels - Level sizes") {
+    auto sizes = simp_algorithms::Simplification_Levels::sizes(100, 2);
+    CHECK(sizes == std::vector<size_t>{50, 25, 13, 6, 3, 2});
+    CHECK(simp_algorithms::Simplification_Levels::sizes(2, 2).empty());
+}
+
+TEST_CASE("Simplification_Levels - Synchronized distance") {
+    auto start = data_structures::Location(1, 0, 0, 0);
+    auto end = data_structures::Location(3, 10, 10, 0);
+    CHECK(simp_algorithms::Simplification_Levels::synchronized_distance(
+            start, data_structures::Location(2, 5, 5, 3), end) == doctest::Approx(3));
+    CHECK(simp_algorithms::Simplification_Levels::synchronized_distance(
+            start, data_structures::Location(2, 2, 5, 0), end) == doctest::Approx(3));
+}
+
+TEST_CASE("TD_TR - Levels are valid Douglas-Peucker simplifications") {
+    auto tt = test_trajectories{};
+    auto levels = simp_algorithms::TD_TR{1.5}(tt.gps);
+
+    REQUIRE(!levels.empty());
+    CHECK(is_valid(levels, tt.gps));
+    CHECK(levels.back().size() == 2);
+
+    SUBCASE("Coarser levels keep a subset of the locations of finer levels") {
+        CHECK(is_nested(levels));
+    }
+
+    auto distances = simp_algorithms::TD_TR::split_distances(tt.gps);
+    CHECK(std::isinf(distances.front()));
+    CHECK(std::isinf(distances.back()));
+}
+
+TEST_CASE("SQUISH_E - Levels are valid simplifications") {
+    auto tt = test_trajectories{};
+    auto levels = simp_algorithms::SQUISH_E{1.5}(tt.gps);
+
+    REQUIRE(!levels.empty());
+    CHECK(is_valid(levels, tt.gps));
+    CHECK(levels.back().size() == 2);
+    CHECK(is_nested(levels));
+
+    auto steps = simp_algorithms::SQUISH_E::removal_steps(tt.small);
+    CHECK(std::isinf(steps.front()));
+    CHECK(std::isinf(steps.back()));
+    CHECK(is_valid(simp_algorithms::SQUISH_E{1.2}(tt.small), tt.small));
+}
+
+TEST_CASE("OPW - Simplifications uphold the error tolerance") {
+    auto tt = test_trajectories{};
+    auto opw = simp_algorithms::OPW{1.5};
+
+    for (double error_tolerance : {0.0001, 0.001, 0.01}) {
+        auto simplified = opw.simplify_at(tt.gps, error_tolerance);
+        CHECK(largest_distance(tt.gps, simplified) <= error_tolerance);
+    }
+
+    auto levels = opw(tt.gps);
+    REQUIRE(!levels.empty());
+    CHECK(is_valid(levels, tt.gps));
+
+    CHECK_THROWS(simp_algorithms::OPW(1.5, 2));
+    CHECK(opw.simplify_at(data_structures::Trajectory{}, 1).size() == 0);
+}
@@ -1,6 +1,7 @@
 #ifndef TRACE_Q_TEST_TRAJECTORIES_HPP
 #define TRACE_Q_TEST_TRAJECTORIES_HPP
 
+#include <random>
 #include "../src/simp-algorithms/MRPA.hpp"
 
 struct test_trajectories {
@@ -13,6 +14,7 @@ struct test_trajectories {
     data_structures::Trajectory small{};
     data_structures::Trajectory medium{};
     data_structures::Trajectory large{};
+    data_structures::Trajectory gps{};
 
     test_trajectories() {
         small.locations.emplace_back(data_structures::Location(1, 0, 1, 2));
@@ -50,6 +52,20 @@ struct test_trajectories {
         large.locations.emplace_back(data_structures::Location(16, 50, 243, 98));
         large.locations.emplace_back(data_structures::Location(17, 53, 277, 143));
         large.locations.emplace_back(data_structures::Location(18, 60, 300, 200));
+
+        // A random walk with GPS-like coordinates and epoch timestamps
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> step(-0.001, 0.001);
+        std::uniform_int_distribution<unsigned long> interval(1, 600);
+        double longitude = 116.3;
+        double latitude = 39.9;
+        unsigned long timestamp = 1201930000;
+        for (int i = 1; i <= 300; ++i) {
+            gps.locations.emplace_back(data_structures::Location(i, timestamp, longitude, latitude));
+            longitude += step(gen);
+            latitude += step(gen);
+            timestamp += interval(gen);
+        }
     }
 };
 
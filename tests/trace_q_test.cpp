@@ -0,0 +1,76 @@
+#include <doctest/doctest.h>
+#include <stdexcept>
+#include <string>
+#include "../src/simp-algorithms/TRACE_Q.hpp"
+#include "../src/simp-algorithms/MRPA.hpp"
+#include "../src/simp-algorithms/TD_TR.hpp"
+#include "../src/simp-algorithms/OPW.hpp"
+
+using trace_q::TRACE_Q;
+
+namespace {
+
+    TRACE_Q make_trace_q(double resolution_scale, int knn_k, TRACE_Q::Simplifier simplifier = {}) {
+        return TRACE_Q{resolution_scale, 0.9, 0.8, 8, 4, 0.1, 0.2, 3, 1.3, 0.1, 0.5, knn_k, true, false,
+                       std::move(simplifier)};
+    }
+
+    bool contains(std::string const& text, std::string const& part) {
+        return text.find(part) != std::string::npos;
+    }
+
+}
+
+TEST_CASE("TRACE_Q - Parameters describe the default simplifier and the query settings") {
+    CHECK(make_trace_q(2, 10).parameters() ==
+          "simplifier=mrpa(metric=sed,resolution_scale=2,mode=cascading)"
+          ";min_range_query_accuracy=0.90000000000000002;min_knn_query_accuracy=0.80000000000000004"
+          ";range_query_grid_density=0.10000000000000001;knn_query_grid_density=0.20000000000000001"
+          ";windows_per_grid_point=3;window_expansion_rate=1.3;range_query_time_interval_multiplier=0.10000000000000001"
+          ";knn_query_time_interval_multiplier=0.5;knn_k=10;use_KNN_for_query_accuracy=1;use_tolerance_bisection=0");
+}
+
+TEST_CASE("TRACE_Q - Parameters are the same for the same settings") {
+    CHECK(make_trace_q(1.5, 10).parameters() == make_trace_q(1.5, 10).parameters());
+    CHECK(make_trace_q(1.5, 10, simp_algorithms::OPW{1.5, 20}).parameters() ==
+          make_trace_q(1.5, 10, simp_algorithms::OPW{1.5, 20}).parameters());
+}
+
+TEST_CASE("TRACE_Q - Parameters change with the settings of the simplifier") {
+    auto default_parameters = make_trace_q(2, 10).parameters();
+
+    SUBCASE("Resolution scale") {
+        CHECK(make_trace_q(3, 10).parameters() != default_parameters);
+    }
+
+    SUBCASE("Mode") {
+        auto independent = make_trace_q(2, 10, simp_algorithms::MRPA{2, simp_algorithms::MRPA_Mode::independent});
+        CHECK(independent.parameters() != default_parameters);
+        CHECK(contains(independent.parameters(), "simplifier=mrpa(metric=sed,resolution_scale=2,mode=independent)"));
+    }
+
+    SUBCASE("Error metric") {
+        CHECK(contains(make_trace_q(2, 10, simp_algorithms::PED_MRPA{2}).parameters(), "mrpa(metric=ped,"));
+        CHECK(contains(make_trace_q(2, 10, simp_algorithms::DAD_MRPA{2}).parameters(), "mrpa(metric=dad,"));
+    }
+
+    SUBCASE("Algorithm") {
+        CHECK(contains(make_trace_q(2, 10, simp_algorithms::TD_TR{2}).parameters(),
+                       "simplifier=td_tr(resolution_scale=2);"));
+    }
+
+    SUBCASE("Window size") {
+        CHECK(make_trace_q(2, 10, simp_algorithms::OPW{2, 20}).parameters() !=
+              make_trace_q(2, 10, simp_algorithms::OPW{2, 40}).parameters());
+    }
+
+    SUBCASE("Query settings") {
+        CHECK(make_trace_q(2, 5).parameters() != default_parameters);
+    }
+}
+
+TEST_CASE("TRACE_Q - A candidate generator without a description is rejected") {
+    TRACE_Q::Candidate_Generator generator = simp_algorithms::TD_TR{2};
+    CHECK_THROWS_AS(make_trace_q(2, 10, {generator, ""}), std::invalid_argument);
+    CHECK_NOTHROW(make_trace_q(2, 10, {generator, "custom"}));
+}
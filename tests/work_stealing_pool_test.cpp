@@ -0,0 +1,156 @@
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../src/concurrency/Work_Stealing_Pool.hpp"
+
+TEST_CASE("Work_Stealing_Pool - Submitted tasks are executed") {
+    auto pool = concurrency::Work_Stealing_Pool{4};
+
+    SUBCASE("Futures hold the results of the tasks") {
+        std::vector<std::future<int>> futures{};
+        for (int i = 0; i < 100; ++i) {
+            futures.emplace_back(pool.submit([](int x) { return x * x; }, i));
+        }
+        for (int i = 0; i < 100; ++i) {
+            CHECK(futures[i].get() == i * i);
+        }
+    }
+
+    SUBCASE("Exceptions are propagated through the future") {
+        auto future = pool.submit([]() -> int { throw std::runtime_error("task failed"); });
+        CHECK_THROWS(future.get());
+    }
+
+    SUBCASE("Tasks submitted by a task are executed") {
+        auto future = pool.submit([&pool]() { return pool.submit([]() { return 42; }); });
+        CHECK(future.get().get() == 42);
+    }
+}
+
+TEST_CASE("Work_Stealing_Pool - Idle workers steal queued tasks") {
+    auto pool = concurrency::Work_Stealing_Pool{2};
+    std::atomic<bool> released{false};
+    std::atomic<int> counter{0};
+
+    // Round-robin places one blocking task and half of the short tasks in each queue
+    std::vector<std::future<void>> blocked{};
+    blocked.emplace_back(pool.submit([&released]() {
+        while (!released) {
+            std::this_thread::yield();
+        }
+    }));
+    std::vector<std::future<void>> futures{};
+    for (int i = 0; i < 20; ++i) {
+        futures.emplace_back(pool.submit([&counter]() { counter++; }));
+    }
+
+    // The short tasks behind the blocking task can only finish by being stolen
+    for (auto& future : futures) {
+        future.wait();
+    }
+    CHECK(counter == 20);
+    released = true;
+    blocked.front().get();
+}
+
+TEST_CASE("Work_Stealing_Pool - Thieves take the oldest queued task") {
+    auto pool = concurrency::Work_Stealing_Pool{2};
+    std::mutex mutex{};
+    std::condition_variable stolen{};
+    std::vector<int> order{};
+
+    // Tasks submitted by a task go to its worker's queue, in order of decreasing cost like simplify_all
+    auto owner = pool.submit([&]() {
+        std::vector<std::future<void>> futures{};
+        for (int cost = 5; cost >= 1; --cost) {
+            futures.emplace_back(pool.submit([&, cost]() {
+                std::scoped_lock lock{mutex};
+                order.push_back(cost);
+                stolen.notify_all();
+            }));
+        }
+
+        // The owner stays busy until the other worker has stolen every task
+        std::unique_lock lock{mutex};
+        stolen.wait_for(lock, std::chrono::seconds(10), [&order]() { return order.size() == 5; });
+    });
+    owner.get();
+
+    CHECK(order == std::vector<int>{5, 4, 3, 2, 1});
+}
+
+TEST_CASE("Work_Stealing_Pool - Tasks can wait for the tasks they submit") {
+    // A single worker can only finish the outer task by running the inner tasks while it waits
+    auto pool = concurrency::Work_Stealing_Pool{1};
+
+    auto outer = pool.submit([&pool]() {
+        std::vector<std::future<int>> inner{};
+        for (int i = 0; i < 10; ++i) {
+            inner.emplace_back(pool.submit([i]() { return i; }));
+        }
+        int sum = 0;
+        for (auto& future : inner) {
+            sum += pool.get(future);
+        }
+        return sum;
+    });
+    CHECK(pool.get(outer) == 45);
+}
+
+TEST_CASE("Work_Stealing_Pool - parallel_for covers every index once") {
+    auto pool = concurrency::Work_Stealing_Pool{3};
+
+    SUBCASE("From outside the pool") {
+        std::vector<int> visits(1000, 0);
+        pool.parallel_for(0, visits.size(), [&visits](size_t begin, size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                visits[i]++;
+            }
+        });
+        CHECK(std::ranges::all_of(visits, [](int count) { return count == 1; }));
+    }
+
+    SUBCASE("Nested inside tasks") {
+        std::atomic<int> sum{0};
+        pool.parallel_for(0, 8, [&pool, &sum](size_t begin, size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                pool.parallel_for(0, 100, [&sum](size_t inner_begin, size_t inner_end) {
+                    sum += static_cast<int>(inner_end - inner_begin);
+                });
+            }
+        });
+        CHECK(sum == 800);
+    }
+
+    SUBCASE("Empty ranges and exceptions") {
+        bool called = false;
+        pool.parallel_for(5, 5, [&called](size_t, size_t) { called = true; });
+        CHECK_FALSE(called);
+        CHECK_THROWS(pool.parallel_for(0, 10, [](size_t begin, size_t) {
+            if (begin == 0) {
+                throw std::runtime_error("chunk failed");
+            }
+        }));
+    }
+}
+
+TEST_CASE("Work_Stealing_Pool - Queued tasks finish before the pool is destroyed") {
+    std::atomic<int> counter{0};
+    {
+        auto pool = concurrency::Work_Stealing_Pool{3};
+        for (int i = 0; i < 50; ++i) {
+            pool.submit([&counter]() { counter++; });
+        }
+    }
+    CHECK(counter == 50);
+}
+
+TEST_CASE("Work_Stealing_Pool - A pool has at least one worker") {
+    CHECK(concurrency::Work_Stealing_Pool{0}.size() == 1);
+    CHECK(concurrency::Work_Stealing_Pool::shared().size() >= 1);
+}